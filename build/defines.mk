@@ -162,12 +162,6 @@ CPATH     := $(CPATH):$(LIBPATH)/FreeSOLID-2.1.1/include
 LIBS += -lFreeSOLID
 endif
 
-ifeq ($(ANN),1)
-DEPEND_UBUNTU += libann-dev
-CXXFLAGS  += -DRAI_ANN
-LIBS += -lann
-endif
-
 ifeq ($(QHULL),1)
 DEPEND_UBUNTU += libqhull-dev
 CXXFLAGS  += -DRAI_QHULL
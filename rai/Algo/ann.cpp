@@ -9,37 +9,134 @@
 #include "ann.h"
 #include "algos.h"
 
-#ifdef RAI_ANN
+#include <algorithm>
+#include <Core/thread.h>
+
+//===========================================================================
+
+/// the k best candidates found so far, sorted by increasing distance
+struct KnnCandidates {
+  uint k;
+  arr d;
+  intA i;
+  KnnCandidates(uint _k) : k(_k) { d.resize(k) = std::numeric_limits<double>::infinity(); i.resize(k) = -1; }
+  double worst() const { return d.p[k-1]; }
+  void insert(double dist, int idx) {
+    if(dist>=worst()) return;
+    uint j=k-1;
+    for(; j>0 && d.p[j-1]>dist; j--) { d.p[j]=d.p[j-1]; i.p[j]=i.p[j-1]; }
+    d.p[j]=dist;
+    i.p[j]=idx;
+  }
+};
+
+/// a static kd-tree; it owns a (reordered) copy of its points, so it never refers into ANN::X
+struct StaticKdTree {
+  struct Node { uint lo, hi; int dim; double split; int left, right; }; //leaf if dim<0
+  arr pts;             ///< points, reordered such that each node's points are contiguous
+  uintA idx;           ///< global index (row in ANN::X) of each row of pts
+  std::vector<Node> nodes;
+  static const uint leafSize=8;
+
+  StaticKdTree(const arr& X, const uintA& ids) {
+    idx = ids;
+    uint d=X.d1;
+    pts.resize(idx.N, d);
+    buildNode(X, 0, idx.N);
+    for(uint r=0; r<idx.N; r++) memmove(pts.p+r*d, X.p+idx.p[r]*d, d*sizeof(double));
+  }
 
-#include <ANN/ANN.h>
+  int buildNode(const arr& X, uint lo, uint hi) {
+    int n=nodes.size();
+    nodes.push_back(Node{lo, hi, -1, 0., -1, -1});
+    if(hi-lo<=leafSize) return n;
+    //split along the dimension of largest spread
+    uint d=X.d1, best=0;
+    double bestSpread=-1.;
+    for(uint j=0; j<d; j++) {
+      double mi=X.p[idx.p[lo]*d+j], ma=mi;
+      for(uint r=lo+1; r<hi; r++) { double v=X.p[idx.p[r]*d+j]; if(v<mi) mi=v; if(v>ma) ma=v; }
+      if(ma-mi>bestSpread) { bestSpread=ma-mi; best=j; }
+    }
+    if(bestSpread<=0.) return n; //all points equal
+    uint mid=(lo+hi)/2;
+    std::nth_element(idx.p+lo, idx.p+mid, idx.p+hi, [&X, d, best](uint a, uint b) { return X.p[a*d+best]<X.p[b*d+best]; });
+    double split = X.p[idx.p[mid]*d+best];
+    int left = buildNode(X, lo, mid);
+    int right = buildNode(X, mid, hi);
+    Node& node=nodes[n];
+    node.dim=best;  node.split=split;  node.left=left;  node.right=right;
+    return n;
+  }
+
+  void search(KnnCandidates& C, const double* q, double epsFactor, int n=0) const {
+    const Node& node=nodes[n];
+    uint d=pts.d1;
+    if(node.dim<0) {
+      for(uint r=node.lo; r<node.hi; r++) {
+        const double *x=pts.p+r*d;
+        double dist=0.;
+        for(uint j=0; j<d; j++) { double z=x[j]-q[j]; dist+=z*z; }
+        C.insert(dist, idx.p[r]);
+      }
+      return;
+    }
+    double diff = q[node.dim]-node.split;
+    int near=node.left, far=node.right;
+    if(diff>=0.) { near=node.right; far=node.left; }
+    search(C, q, epsFactor, near);
+    if(diff*diff*epsFactor < C.worst()) search(C, q, epsFactor, far);
+  }
+};
 
 struct sANN {
-  ANNkd_tree *tree=0;
-  //PartialLeastSquares pls;
-  rai::Array<double*> cpointers;
-  uint treeSize;   //for how many entries in X have we build the tree?
-  void clear() { if(tree) delete tree;   tree=NULL;  cpointers.clear();  treeSize=0; }
+  rai::Array<StaticKdTree*> forest; ///< forest(l) is NULL or a tree over a multiple of bufferSize*2^l points
+  uint treeSize=0;   //for how many entries in X have we build the trees? (the rest is searched brute-force)
+  void clear() { for(StaticKdTree *t:forest) if(t) delete t;  forest.clear();  treeSize=0; }
+
+  /// merge the points [treeSize, X.d0) into the forest (logarithmic method)
+  void mergeBuffer(const arr& X) {
+    uintA ids;
+    ids.setStraightPerm(X.d0-treeSize);
+    ids += treeSize;
+    uint l=0;
+    for(; l<forest.N && forest(l); l++) {
+      ids.append(forest(l)->idx);
+      delete forest(l);
+      forest(l)=NULL;
+    }
+    if(l==forest.N) forest.append(NULL);
+    forest(l) = new StaticKdTree(X, ids);
+    treeSize = X.d0;
+  }
+
+  void search(KnnCandidates& C, const arr& X, const double* q, double eps) const {
+    double epsFactor = (1.+eps)*(1.+eps);
+    for(StaticKdTree *t:forest) if(t) t->search(C, q, epsFactor);
+    uint d=X.d1;
+    for(uint i=treeSize; i<X.d0; i++) {
+      const double *x=X.p+i*d;
+      double dist=0.;
+      for(uint j=0; j<d; j++) { double z=x[j]-q[j]; dist+=z*z; }
+      C.insert(dist, i);
+    }
+  }
 };
 
 ANN::ANN() {
-  bufferSize = 1 <<10;
+  bufferSize = 32;
   s = new sANN;
-  s->tree = 0;
-  s->treeSize = 0;
 }
 
 ANN::ANN(const ANN& ann) {
-  bufferSize = 1 <<10;
+  bufferSize = ann.bufferSize;
   s = new sANN;
-  s->tree = 0;
-  s->treeSize = 0;
   setX(ann.X);
 }
 
 ANN::~ANN() {
   s->clear();
   delete s;
-  //annClose(); //mt09-07-29 this would close down the ANN lib completely
 }
 
 void ANN::clear() {
@@ -53,60 +150,39 @@ void ANN::setX(const arr& _XX) {
 }
 
 void ANN::append(const arr& x) {
-  double *p=X.p;
   X.append(x);
   if(X.N==x.d0) X.reshape(1, x.d0);
-  if(X.p!=p) s->clear(); //when the memory location changed clear the tree! (implies recomputation)
+  //the trees own copies of their points: a reallocation of X does not invalidate them
+  if(X.d0-s->treeSize>bufferSize) s->mergeBuffer(X);
 }
 
 void ANN::calculate() {
-  if(s->treeSize == X.d0) return;
+  if(s->treeSize == X.d0 && s->forest.N==1) return;
   s->clear();
-  X.getCarray(s->cpointers);
-  s->tree = new ANNkd_tree(s->cpointers.p, X.d0, X.d1);
+  uintA ids;
+  ids.setStraightPerm(X.d0);
+  s->forest.append(new StaticKdTree(X, ids));
   s->treeSize = X.d0;
 }
 
 void ANN::getkNN(arr& dists, intA& idx, const arr& x, uint k, double eps, bool verbose) {
   CHECK_GE(X.d0, k, "data has less (" <<X.d0 <<") than k=" <<k <<" points");
   CHECK_EQ(x.N,X.d1, "query point has wrong dimension. x.N=" << x.N << ", X.d1=" << X.d1);
-  
+
   if(X.d0-s->treeSize>bufferSize) {
-    if(verbose) std::cout <<"ANN recomputing: X.d0=" <<X.d0 <<" treeSize=" <<s->treeSize <<std::endl;
-    calculate();
-  }
-  uint restStartsAt;
-  if(s->treeSize>=k) {
-    dists.resize(k);
-    idx.resize(k);
-    s->tree->annkSearch(x.p, k, idx.p, dists.p, eps);
-    restStartsAt=s->treeSize;
-  } else {
-    dists.clear();
-    idx.clear();
-    restStartsAt=0;
-  }
-  
-  //now check if in the rest of X there are even nearer points
-  for(uint i=restStartsAt; i<X.d0; i++) {
-    for(uint j=0; j<=idx.N && j<k; j++) {
-      double d=sqrDistance(X[i], x);
-      if(j==idx.N || d < dists(j)) {
-        idx.insert(j, i);
-        dists.insert(j, d);
-        break;
-      }
-    }
-  }
-  if(idx.N>k) {
-    idx.resizeCopy(k);
-    dists.resizeCopy(k);
+    if(verbose) std::cout <<"ANN merging: X.d0=" <<X.d0 <<" treeSize=" <<s->treeSize <<std::endl;
+    s->mergeBuffer(X);
   }
-  
+
+  KnnCandidates C(k);
+  s->search(C, X, x.p, eps);
+  dists = C.d;
+  idx = C.i;
+
   if(verbose) {
     std::cout
         <<"ANN query:"
-        <<"\n data size = " <<X.d0 <<"  data dim = " <<X.d1 <<"  treeSize = " <<s->treeSize
+        <<"\n data size = " <<X.d0 <<"  data dim = " <<X.d1 <<"  treeSize = " <<s->treeSize <<"  #trees = " <<s->forest.N
         <<"\n query point " <<x
         <<"\n found neighbors:\n";
     for(uint i=0; i<idx.N; i++) {
@@ -119,6 +195,22 @@ void ANN::getkNN(arr& dists, intA& idx, const arr& x, uint k, double eps, bool v
   }
 }
 
+void ANN::getkNN_batch(arr& dists, intA& idx, const arr& Q, uint k, double eps, uint threads) {
+  CHECK_GE(X.d0, k, "data has less (" <<X.d0 <<") than k=" <<k <<" points");
+  CHECK_EQ(Q.d1, X.d1, "query points have wrong dimension");
+  if(X.d0-s->treeSize>bufferSize) s->mergeBuffer(X);
+
+  dists.resize(Q.d0, k);
+  idx.resize(Q.d0, k);
+  if(Q.d0<2*threads) threads=1;
+  parallelFor(Q.d0, [this, &dists, &idx, &Q, k, eps](uint q) {
+    KnnCandidates C(k);
+    s->search(C, X, Q.p+q*Q.d1, eps);
+    memmove(dists.p+q*k, C.d.p, k*sizeof(double));
+    memmove(idx.p+q*k, C.i.p, k*sizeof(int));
+  }, threads);
+}
+
 uint ANN::getNN(const arr& x, double eps, bool verbose) {
   intA idx;
   arr dists;
@@ -138,18 +230,3 @@ void ANN::getkNN(arr& xx             , const arr& x, uint k, double eps, bool ve
   xx.resize(idx.N, X.d1);
   for(uint i=0; i<idx.N; i++) xx[i]=X[idx(i)];
 }
-
-#else //RAI_ANN
-
-ANN::ANN() { NICO }
-ANN::~ANN() { NICO }
-
-void ANN::calculate() { NICO }
-void ANN::setX(const arr& _XX) { NICO }
-void ANN::append(const arr& x) { NICO }
-uint ANN::getNN(const arr& x, double eps, bool verbose) { NICO }
-void ANN::getkNN(intA& idx, const arr& x, uint k, double eps, bool verbose) { NICO }
-void ANN::getkNN(arr& sqrDists, intA& idx, const arr& x, uint k, double eps, bool verbose) { NICO }
-void ANN::getkNN(arr& X, const arr& x, uint k, double eps, bool verbose) { NICO }
-
-#endif
@@ -21,11 +21,18 @@
 // Approximate Nearest Neighbor Search (kd-tree)
 //
 
+/// nearest neighbor index over the rows of X; supports incremental growth: appended points are
+/// first searched brute-force (up to bufferSize), then merged into a logarithmic forest of static
+/// kd-trees like a binary counter (a merge rebuilds the lowest occupied levels into the first free
+/// one, so tree l holds at least (bufferSize+1)*2^l points), which gives amortized logarithmic
+/// insertion without full rebuilds. Each tree owns a copy of its points, so reallocations of X never
+/// invalidate the index. Queries are not thread-safe: they first merge an overfull buffer, modifying
+/// the index. getkNN_batch merges once and then searches in parallel.
 struct ANN {
   struct sANN *s;
   
   arr X;       //the data set for which a ANN tree is build
-  uint bufferSize; //a tree is only rebuild if there are more than 'buffer' new points appended [default: 20]
+  uint bufferSize; //new points are only merged into the forest if there are more than 'buffer' of them [default: 32]
   
   ANN();
   ANN(const ANN& ann);
@@ -34,12 +41,15 @@ struct ANN {
   void clear();              //clears the tree and X
   void setX(const arr& _X);  //set X
   void append(const arr& x); //append to X
-  void calculate();          //compute a tree for all of X
+  void calculate();          //compute a single tree for all of X
   
   uint getNN(const arr& x, double eps=.0, bool verbose=false);
   void getkNN(intA& idx, const arr& x, uint k, double eps=.0, bool verbose=false);
   void getkNN(arr& sqrDists, intA& idx, const arr& x, uint k, double eps=.0, bool verbose=false);
   void getkNN(arr& X, const arr& x, uint k, double eps=.0, bool verbose=false);
+
+  /// batch query: for each row of Q the k nearest neighbors (rows of sqrDists and idx); uses 'threads' threads (0=hardware concurrency)
+  void getkNN_batch(arr& sqrDists, intA& idx, const arr& Q, uint k, double eps=.0, uint threads=0);
 };
 
 #endif
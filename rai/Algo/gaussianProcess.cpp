@@ -13,6 +13,64 @@
 /** prior of 0 */
 double const_0(const arr &x, const void *p) {return 0.;}
 
+//-- helpers on a lower triangular matrix L, packed row-wise (row i starts at i(i+1)/2)
+
+inline double* packedRow(arr& L, uint i) { return L.p + i*(i+1)/2; }
+inline const double* packedRow(const arr& L, uint i) { return L.p + i*(i+1)/2; }
+
+/// in place: b <- L^{-1} b
+static void forwardSubstitution(arr& b, const arr& L) {
+  for(uint i=0; i<b.N; i++) {
+    const double *Li = packedRow(L, i);
+    double z = b.p[i];
+    for(uint j=0; j<i; j++) z -= Li[j]*b.p[j];
+    b.p[i] = z/Li[i];
+  }
+}
+
+/// in place: b <- L^{-T} b
+static void backwardSubstitution(arr& b, const arr& L) {
+  for(uint i=b.N; i--;) {
+    const double *Li = packedRow(L, i);
+    double x = b.p[i] /= Li[i];
+    for(uint j=0; j<i; j++) b.p[j] -= Li[j]*x;
+  }
+}
+
+/// in place for m right-hand sides (B is n x m): B <- L^{-1} B; inner loops run over contiguous rows
+static void forwardSubstitution_rows(arr& B, const arr& L) {
+  uint n=B.d0, m=B.d1;
+  for(uint i=0; i<n; i++) {
+    const double *Li = packedRow(L, i);
+    double *Bi = B.p+i*m;
+    for(uint j=0; j<i; j++) {
+      const double *Bj = B.p+j*m, l=Li[j];
+      for(uint k=0; k<m; k++) Bi[k] -= l*Bj[k];
+    }
+    double inv = 1./Li[i];
+    for(uint k=0; k<m; k++) Bi[k] *= inv;
+  }
+}
+
+/// packed Cholesky factor of a symmetric positive definite matrix
+static void choleskyPacked(arr& L, const arr& G) {
+  uint n=G.d0;
+  L.resize(n*(n+1)/2);
+  for(uint i=0; i<n; i++) {
+    double *Li = packedRow(L, i);
+    for(uint j=0; j<=i; j++) {
+      const double *Lj = packedRow(L, j);
+      double z = G(i, j);
+      for(uint k=0; k<j; k++) z -= Li[k]*Lj[k];
+      if(j<i) Li[j] = z/Lj[j];
+      else {
+        CHECK(z>0., "Gram matrix is not positive definite (duplicate inputs need obsVar>0)");
+        Li[i] = ::sqrt(z);
+      }
+    }
+  }
+}
+
 GaussianProcess::GaussianProcess() :
   mu(0.),
   mu_func(const_0),
@@ -66,7 +124,7 @@ void GaussianProcess::recompute() {
   uint i, j, N=Y.N, dN=dY.N;
   arr gram, xi, xj, Mu_func;
   gram.resize(N+dN, N+dN);
-  if(!gram.N) return;
+  if(!gram.N) { L.clear(); Yc.clear(); GinvY.clear(); return; }
   for(i=0; i<N; i++) {
     xi.referToDim(X, i);
     gram(i, i) = cov(kernelP, xi, xi);
@@ -93,31 +151,83 @@ void GaussianProcess::recompute() {
       }
     }
   }
-  gram = gram + obsVar * eye(gram.d0);
-  inverse_SymPosDef(Ginv, gram);
-  if(!dN) {
-    if(N) GinvY = Ginv * (Y-Mu_func-mu); else GinvY.clear();
-  } else {
-    arr Yfull; Yfull.append(Y-Mu_func-mu); Yfull.append(dY);
-    GinvY = Ginv * Yfull;
-  }
-  //cout <<"gram=" <<gram <<" Ginv=" <<Ginv <<endl;
+  for(i=0; i<gram.d0; i++) gram(i, i) += obsVar;
+  choleskyPacked(L, gram);
+  Yc.clear();
+  if(N) Yc = Y-Mu_func-mu;
+  if(dN) Yc.append(dY);
+  updateGinvY();
+}
+
+void GaussianProcess::updateGinvY() {
+  GinvY = Yc;
+  forwardSubstitution(GinvY, L);
+  backwardSubstitution(GinvY, L);
 }
 
 void GaussianProcess::appendObservation(const arr& x, double y) {
   uint N=X.d0;
+  bool incremental = !dY.N && factorIsValid();
   X.append(x); //append it to the data
   Y.append(y);
   X.reshape(N+1, x.N);
   Y.reshape(N+1);
+  if(incremental) { //extend the Cholesky factor by one row: l = L^{-1} k, diagonal = sqrt(kappa - l^T l)
+    arr l(N), xi;
+    for(uint i=0; i<N; i++) { xi.referToDim(X, i); l(i) = cov(kernelP, x, xi); }
+    forwardSubstitution(l, L);
+    double d = cov(kernelP, x, x) + obsVar - sumOfSqr(l);
+    CHECK(d>0., "Gram matrix is not positive definite (duplicate inputs need obsVar>0)");
+    l.append(::sqrt(d));
+    L.append(l);
+    Yc.append(y - mu_func(x, priorP) - mu);
+    updateGinvY();
+  } else { //derivative data or a stale factor: rebuild it
+    while(maxData && Y.N>maxData) { X.delRows(0); Y.remove(0); }
+    recompute();
+  }
+  while(maxData && Y.N>maxData) removeObservation(0);
 #if RAI_GP_DEBUG
-  arr iG=Ginv;
+  arr L2=L;
   recompute();
-  double err=maxDiff(iG, Ginv);
-  CHECK(err<1e-6, "mis-updated inverse Gram matrix" <<err <<endl <<iG <<Ginv);
+  double err=maxDiff(L2, L);
+  CHECK(err<1e-6, "mis-updated Cholesky factor" <<err <<endl <<L2 <<L);
 #endif
 }
 
+void GaussianProcess::removeObservation(uint r) {
+  uint N=Y.N;
+  CHECK_LE(r+1, N, "");
+  bool downdate = !dY.N && factorIsValid();
+  X.delRows(r);
+  Y.remove(r);
+  if(!downdate) { recompute(); return; }
+  Yc.remove(r);
+
+  //drop row and column r; the trailing block needs the rank-one update L33 L33^T + l32 l32^T
+  arr x(N-1-r), Lnew((N-1)*N/2);
+  for(uint i=0; i<N; i++) if(i!=r) {
+      uint inew = i<r?i:i-1;
+      const double *Li = packedRow(L, i);
+      double *Ln = packedRow(Lnew, inew);
+      for(uint j=0, jnew=0; j<=i; j++) if(j!=r) Ln[jnew++] = Li[j];
+      if(i>r) x(i-r-1) = Li[r];
+    }
+  for(uint k=r; k<N-1; k++) {
+    double *Lk = packedRow(Lnew, k);
+    double xk = x(k-r), rr = ::sqrt(Lk[k]*Lk[k] + xk*xk);
+    double c = rr/Lk[k], s = xk/Lk[k];
+    Lk[k] = rr;
+    for(uint j=k+1; j<N-1; j++) {
+      double& Ljk = packedRow(Lnew, j)[k];
+      Ljk = (Ljk + s*x(j-r))/c;
+      x(j-r) = c*x(j-r) - s*Ljk;
+    }
+  }
+  L = Lnew;
+  updateGinvY();
+}
+
 void GaussianProcess::appendDerivativeObservation(const arr& x, double y, uint i) {
   uint N=dX.d0;
   dX.append(x); //append it to the data
@@ -138,7 +248,7 @@ double GaussianProcess::max_var() {
 
 void GaussianProcess::evaluate(const arr& x, double& y, double& sig, bool calcSig) {
   uint i, N=Y.N, dN=dY.N;
-  /*static*/ arr k, xi, Ginvk; //danny: why was there a static
+  /*static*/ arr k, xi; //danny: why was there a static
   if(N+dN==0) { //no data
     y = mu_func(x, priorP) + mu;
     sig=::sqrt(cov(kernelP, x, x));
@@ -151,13 +261,13 @@ void GaussianProcess::evaluate(const arr& x, double& y, double& sig, bool calcSi
   
   y = scalarProduct(k, GinvY) + mu_func(x, priorP) + mu;
   if(calcSig) {
-    innerProduct(Ginvk, Ginv, k);
-    sig = cov(kernelP, x, x) - scalarProduct(k, Ginvk);
+    forwardSubstitution(k, L);
+    sig = cov(kernelP, x, x) - sumOfSqr(k);
+    if(sig<0.) sig=0.;
     //if(sig<=10e-10) {
     //cout << "---" << endl;
     //cout << "x==" << x << endl;
     //cout << "k==" << k << endl;
-    //cout << "Ginv==" << Ginv << endl;
     //cout << "kGinvk==" << scalarProduct(k, Ginvk) << endl;
     //sig=::sqrt(sig);
     //cout << "sig==" << sig << endl;
@@ -168,9 +278,9 @@ void GaussianProcess::evaluate(const arr& x, double& y, double& sig, bool calcSi
 }
 
 double GaussianProcess::log_likelihood() {
-  arr gram;
-  inverse_SymPosDef(gram, Ginv);
-  return (-.5*~Y*GinvY - .5*log(length(gram)) - (X.N+dX.N)/2 * log(2*RAI_PI))(0); // actually a degenerated array of size 1x1
+  double logDet=0.;
+  for(uint i=0; i<Yc.N; i++) logDet += 2.*::log(packedRow(L, i)[i]);
+  return -.5*scalarProduct(Yc, GinvY) - .5*logDet - .5*Yc.N*::log(2*RAI_PI);
 }
 
 /** vector of covariances between test point and N+dN observation points */
@@ -375,12 +485,34 @@ void GaussianProcess::gradientV(arr& grad, const arr& x) {
   arr k, dk;
   k_star(x, k);
   dk_star(x, dk);
-  grad = -2.0*~k*Ginv*dk;
+  forwardSubstitution(k, L);
+  backwardSubstitution(k, L);
+  grad = -2.0*~k*dk;
 }
 
-void GaussianProcess::evaluate(const arr& X, arr& Y, arr& S) {
-  uint i;
-  arr xi;
-  Y.resize(X.d0); S.resize(X.d0);
-  for(i=0; i<X.d0; i++) { xi.referToDim(X, i); evaluate(xi, Y(i), S(i)); }
+void GaussianProcess::evaluate(const arr& _X, arr& _Y, arr& S) {
+  uint m=_X.d0, N=Y.N, dN=dY.N;
+  arr x, xi;
+  _Y.resize(m); S.resize(m);
+  if(N+dN==0) {
+    for(uint q=0; q<m; q++) { x.referToDim(_X, q); evaluate(x, _Y(q), S(q)); }
+    return;
+  }
+  //cross-covariances, stored transposed (data x queries) for the batched triangular solve
+  arr Kt(N+dN, m);
+  for(uint q=0; q<m; q++) {
+    x.referToDim(_X, q);
+    for(uint i=0; i<N; i++) { xi.referToDim(X, i); Kt(i, q) = cov(kernelP, x, xi); }
+    for(uint i=0; i<dN; i++) { xi.referToDim(dX, i); Kt(N+i, q) = covF_D(dI(i), kernelP, x, xi); }
+  }
+  innerProduct(_Y, ~GinvY, Kt);
+  _Y.reshape(m);
+  forwardSubstitution_rows(Kt, L);
+  for(uint q=0; q<m; q++) {
+    x.referToDim(_X, q);
+    _Y(q) += mu_func(x, priorP) + mu;
+    double s = cov(kernelP, x, x);
+    for(uint i=0; i<Kt.d0; i++) s -= rai::sqr(Kt(i, q));
+    S(q) = s>0. ? ::sqrt(s) : 0.;
+  }
 }
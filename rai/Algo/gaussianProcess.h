@@ -21,7 +21,11 @@ struct GaussianProcess {
   arr X, Y;   ///< data
   arr dX, dY; ///< derivative data
   uintA dI;  ///< derivative data (derivative indexes)
-  arr Ginv, GinvY, ig2;  ///< inverse gram matrix (and a second buffer for push/pop)
+  arr L;      ///< Cholesky factor of the Gram matrix (lower triangular, packed row-wise: row i holds L(i,0..i))
+  arr Yc;     ///< centered targets (Y minus prior mean, then dY) the factor refers to
+  arr GinvY;  ///< inverse Gram matrix times Yc
+  uint maxData=0; ///< if >0: subset-of-data mode, appendObservation drops the oldest datum beyond this size (the dropped data are
+                  ///< forgotten; this is not an inducing-point approximation of the full posterior)
   
   //--prior function
   double mu; ///< const bias of the GP
@@ -57,18 +61,18 @@ struct GaussianProcess {
   
   GaussianProcess(const GaussianProcess &f) {
     X=f.X; Y=f.Y; dX=f.dX; dY=f.dY; dI=f.dI;
-    Ginv=f.Ginv; GinvY=f.GinvY; ig2=f.ig2;
+    L=f.L; Yc=f.Yc; GinvY=f.GinvY; maxData=f.maxData;
     mu=f.mu; mu_func=f.mu_func; priorP=f.priorP;
     cov=f.cov; dcov=f.dcov; covF_D=f.covF_D;
     covD_D=f.covD_D; covDD_F=f.covDD_F; covDD_D=f.covDD_D;
     kernelP=f.kernelP; obsVar=f.obsVar;
   }
   
-  void clear() { X.clear(); Y.clear(); dX.clear(); dY.clear(); dI.clear(); Ginv.clear(); GinvY.clear(); ig2.clear(); }
+  void clear() { X.clear(); Y.clear(); dX.clear(); dY.clear(); dI.clear(); L.clear(); Yc.clear(); GinvY.clear(); }
   
   void copyFrom(GaussianProcess &f) {
     X=f.X; Y=f.Y; dX=f.dX; dY=f.dY; dI=f.dI;
-    Ginv=f.Ginv; GinvY=f.GinvY; ig2=f.ig2;
+    L=f.L; Yc=f.Yc; GinvY=f.GinvY; maxData=f.maxData;
     mu=f.mu; mu_func=f.mu_func; priorP=f.priorP;
     cov=f.cov; dcov=f.dcov; covF_D=f.covF_D;
     covD_D=f.covD_D; covDD_F=f.covDD_F; covDD_D=f.covDD_D;
@@ -114,14 +118,15 @@ struct GaussianProcess {
   void setGaussKernelGP(void *_kernelP, double(*_mu)(const arr&, const void*), void*);
   void setGaussKernelGP(void *_kernelP, double _mu);
   
-  void recompute(const arr& X, const arr&Y);              ///< calculates the inv Gram matrix for the given data
-  void recompute();                                      ///< recalculates the inv Gram matrix for the current data
-  void appendObservation(const arr& x, double y);     ///< add a new datum to the data and updates the inv Gram matrix
+  void recompute(const arr& X, const arr&Y);              ///< calculates the Gram matrix factorization for the given data
+  void recompute();                                      ///< recalculates the Gram matrix factorization for the current data
+  void appendObservation(const arr& x, double y);     ///< add a new datum to the data and updates the factorization (O(n^2) if it was up to date)
+  void removeObservation(uint i);                     ///< removes the i-th datum and downdates the factorization (O(n^2) if it was up to date)
   void appendDerivativeObservation(const arr& x, double dy, uint i);
   void appendGradientObservation(const arr& x, const arr& dydx);
   
   void evaluate(const arr& x, double& y, double& sig, bool calcSig = true);   ///< evaluate the GP at some point - returns y and sig (=standard deviation)
-  void evaluate(const arr& X, arr& Y, arr& S);   ///< evaluate the GP at some array of points - returns all y's and sig's
+  void evaluate(const arr& X, arr& Y, arr& S);   ///< evaluate the GP at some array of points - returns all y's and sig's (batched triangular solve)
   double log_likelihood();
   double max_var(); // the variance when no data present
   void gradient(arr& grad, const arr& x);           ///< evaluate the gradient dy/dx of the mean at some point
@@ -130,8 +135,12 @@ struct GaussianProcess {
   void k_star(const arr& x, arr& k);
   void dk_star(const arr& x, arr& k);
   
-  void push(const arr& x, double y) { ig2=Ginv; appendObservation(x, y); recompute(); }
-  void pop() { Ginv=ig2; X.resizeCopy(X.d0-1, X.d1); Y.resizeCopy(Y.N-1); }
+  void push(const arr& x, double y) { appendObservation(x, y); }
+  void pop() { removeObservation(Y.N-1); }
+
+private:
+  bool factorIsValid() const { uint n=Yc.N; return n==Y.N+dY.N && L.N==n*(n+1)/2; }
+  void updateGinvY();
 };
 
 #define KRONEKER(a, b)   ( ((a)==(b)) ? 1 : 0 )
@@ -261,7 +270,6 @@ inline void randomFunction(GaussianProcess& gp, arr& Xbase, bool illustrate, boo
     gp.evaluate(x, y, sig);      //sample it from the GP itself
     y+=sig*rnd.gauss();        //with standard deviation..
     gp.appendObservation(x, y);
-    gp.recompute();
   }
   
   gp.obsVar=orgObsVar;
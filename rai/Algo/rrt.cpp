@@ -23,21 +23,41 @@ RRT::RRT(const arr& q0, double _stepsize) : s(new sRRT()) {
   s->stepsize = _stepsize;
 }
 double RRT::getProposalTowards(arr& proposal, const arr& q) {
+  return getProposalTowards(proposal, s->nearest, q);
+}
+void RRT::add(const arr& q) {
+  add(q, s->nearest);
+}
+
+uint RRT::getNearest(const arr& q) {
+  return s->ann.getNN(q);
+}
+double RRT::getProposalTowards(arr& proposal, uint& nearest, const arr& q) {
   //find NN
-  s->nearest=s->ann.getNN(q);
-  
+  nearest=s->ann.getNN(q);
+  return getProposalFrom(proposal, nearest, q);
+}
+void RRT::getNearest(uintA& nearest, const arr& Q, uint threads) {
+  arr dists;
+  intA idx;
+  s->ann.getkNN_batch(dists, idx, Q, 1, 0., threads);
+  nearest.resize(Q.d0);
+  for(uint i=0; i<Q.d0; i++) nearest(i) = idx.p[i];
+}
+double RRT::getProposalFrom(arr& proposal, uint nearest, const arr& q) {
   //compute little step
-  arr d = q - s->ann.X[s->nearest]; //difference vector between q and nearest neighbor
+  arr d = q - s->ann.X[nearest]; //difference vector between q and nearest neighbor
   double dist = length(d);
   if(dist > s->stepsize)
-    proposal = s->ann.X[s->nearest] + s->stepsize/dist * d;
+    proposal = s->ann.X[nearest] + s->stepsize/dist * d;
   else
     proposal = q;
   return dist;
 }
-void RRT::add(const arr& q) {
+uint RRT::add(const arr& q, uint parent) {
   s->ann.append(q);
-  s->parent.append(s->nearest);
+  s->parent.append(parent);
+  return s->parent.N-1;
 }
 
 //some access routines
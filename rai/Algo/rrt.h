@@ -19,6 +19,15 @@ public:
   RRT(const arr& q0, double _stepsize);
   double getProposalTowards(arr& proposal, const arr& q);
   void add(const arr& q);
+
+  //variants without the internal 'nearest' state (still not thread-safe: a query may reorganize the ANN index)
+  uint getNearest(const arr& q);
+  double getProposalTowards(arr& proposal, uint& nearest, const arr& q);
+  uint add(const arr& q, uint parent);
+
+  //batch variants: one index query for all rows of Q (in parallel); the proposal from a given node only reads the tree (thread-safe)
+  void getNearest(uintA& nearest, const arr& Q, uint threads=0);
+  double getProposalFrom(arr& proposal, uint nearest, const arr& q);
   
   //some access routines
   double getStepsize();
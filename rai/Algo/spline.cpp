@@ -9,6 +9,8 @@
 #include "spline.h"
 #include <Plot/plot.h>
 
+#include <algorithm>
+
 //==============================================================================
 //
 // Spline
@@ -178,9 +180,104 @@ void Spline::setUniformNonperiodicBasis(uint T, uint nPoints, uint _degree) {
 //  setBasisAndTimeGradient();
 }
 
+//the same Cox-de Boor recursion as getCoeffs, but restricted to the knot span of t
+static const uint maxActiveDegree=7;
+
+int Spline::getActiveCoeffs(double t, double* b, double* db, double* ddb) const {
+  const int D=degree, K=points.d0-1;
+  if(degree>maxActiveDegree) { //high degrees: copy the window out of the full (allocating) recursion
+    int first;
+    if(t<times(0)) first=0;
+    else if(t>=times.last()) first=K-D;
+    else first = std::min<int>(std::upper_bound(times.p, times.p+times.N, t) - times.p - 1, K) - D;
+    arr c = getCoeffs(t, K, 0), dc, ddc;
+    if(db) dc = getCoeffs(t, K, 1);
+    if(ddb) ddc = getCoeffs(t, K, 2);
+    for(int i=0; i<=D; i++) {
+      int k=first+i;
+      bool in = (k>=0 && k<=K);
+      b[i] = in ? c(k) : 0.;
+      if(db) db[i] = in ? dc(k) : 0.;
+      if(ddb) ddb[i] = in ? ddc(k) : 0.;
+    }
+    return first;
+  }
+  double b_0[maxActiveDegree+2], db_0[maxActiveDegree+2], ddb_0[maxActiveDegree+2];
+  double _db[maxActiveDegree+2], _ddb[maxActiveDegree+2];
+  if(!db) db=_db;
+  if(!ddb) ddb=_ddb;
+  for(int i=0; i<=D; i++) b[i]=db[i]=ddb[i]=0.;
+  
+  //-- outside the knots: constant first/last point
+  if(t<times(0)) { b[0]=1.; return 0; }
+  if(t>=times.last()) { b[D]=1.; return K-D; }
+  
+  //-- knot span m with times(m) <= t < times(m+1)
+  int m = std::upper_bound(times.p, times.p+times.N, t) - times.p - 1;
+  if(m>K) m=K;
+  int first=m-D;
+  b[D]=1.;
+  
+  for(int p=1; p<=D; p++) {
+    for(int i=0; i<=D; i++) { b_0[i]=b[i]; db_0[i]=db[i]; ddb_0[i]=ddb[i]; }
+    b_0[D+1]=db_0[D+1]=ddb_0[D+1]=0.;
+    for(int i=0; i<=D; i++) {
+      int k=first+i;
+      b[i]=db[i]=ddb[i]=0.;
+      if(k<0) continue;
+      if(k+p<(int)times.N) {
+        double xden = times(k+p) - times(k);
+        double x = DIV(t - times(k), xden, true);
+        b[i] = x * b_0[i];
+        db[i] = DIV(1., xden, true) * b_0[i] + x * db_0[i];
+        ddb[i] = DIV(2., xden, true) * db_0[i] + x * ddb_0[i];
+      }
+      if(k<K && k+p+1<(int)times.N) {
+        double yden = times(k+p+1) - times(k+1);
+        double y = DIV(times(k+p+1) - t, yden, true);
+        b[i] += y * b_0[i+1];
+        db[i] += DIV(-1., yden, true) * b_0[i+1] + y * db_0[i+1];
+        ddb[i] += DIV(-2., yden, true) * db_0[i+1] + y * ddb_0[i+1];
+      }
+    }
+  }
+  return first;
+}
+
 arr Spline::eval(double t, uint derivative) const {
-  uint K = points.d0-1;
-  return (~getCoeffs(t, K, derivative) * points).reshape(points.d1);
+  CHECK_LE(derivative, 2, "Derivate of order " << derivative << " not yet implemented.");
+  arr f(points.d1);
+  eval(derivative==0?f.p:NULL, derivative==1?f.p:NULL, derivative==2?f.p:NULL, t);
+  return f;
+}
+
+void Spline::eval(double* f, double* fDot, double* fDDot, double t) const {
+  double buffer[3*(maxActiveDegree+1)];
+  arr heap; //only for degrees beyond maxActiveDegree
+  double *b=buffer;
+  if(degree>maxActiveDegree) { heap.resize(3*(degree+1)); b=heap.p; }
+  double *db=b+degree+1, *ddb=db+degree+1;
+  int first = getActiveCoeffs(t, b, fDot?db:NULL, fDDot?ddb:NULL);
+  const uint n=points.d1;
+  if(f) for(uint j=0; j<n; j++) f[j]=0.;
+  if(fDot) for(uint j=0; j<n; j++) fDot[j]=0.;
+  if(fDDot) for(uint j=0; j<n; j++) fDDot[j]=0.;
+  for(uint i=0; i<=degree; i++) {
+    int k=first+i;
+    if(k<0 || k>=(int)points.d0) continue;
+    const double *P=points.p+k*n;
+    if(f) for(uint j=0; j<n; j++) f[j] += b[i]*P[j];
+    if(fDot) for(uint j=0; j<n; j++) fDot[j] += db[i]*P[j];
+    if(fDDot) for(uint j=0; j<n; j++) fDDot[j] += ddb[i]*P[j];
+  }
+}
+
+void Spline::eval(arr& f, arr& fDot, arr& fDDot, const arr& ts) const {
+  const uint n=points.d1;
+  if(!!f) f.resize(ts.N, n);
+  if(!!fDot) fDot.resize(ts.N, n);
+  if(!!fDDot) fDDot.resize(ts.N, n);
+  for(uint i=0; i<ts.N; i++) eval(!!f?f.p+i*n:NULL, !!fDot?fDot.p+i*n:NULL, !!fDDot?fDDot.p+i*n:NULL, ts.p[i]);
 }
 
 arr Spline::eval(uint t) const { return (~basis[t]*points).reshape(points.d1); }
@@ -29,8 +29,17 @@ struct Spline {
   /// for t \in [0,1] the coefficients are the weighting of the points: f(t) = coeffs(t)^T * points
   arr getCoeffs(double t, uint K, uint derivative=0) const;
   
-  /// returns f(t) using getCoeffs for any t \in [0,1]
+  /// allocation-free local version of getCoeffs: only the degree+1 basis functions that are nonzero at t
+  /// (and their 1st and 2nd derivatives; pass NULL to skip); f(t) = sum_i b[i] * points[first+i]
+  /// for all first+i in [0,K]. Returns first (which can be negative for unclamped knots); degrees above 7 fall back to getCoeffs
+  int getActiveCoeffs(double t, double* b, double* db=NULL, double* ddb=NULL) const;
+  
+  /// returns f(t) for any t \in [0,1]
   arr eval(double t, uint derivative=0) const;
+  /// allocation-free: writes f(t), f'(t), f''(t) (each points.d1 doubles; NULL to skip) in one pass
+  void eval(double* f, double* fDot, double* fDDot, double t) const;
+  /// batched: f, f', f'' at all times ts as (ts.N, points.d1)-matrices (pass NoArr to skip) -- no allocation if already sized
+  void eval(arr& f, arr& fDot, arr& fDDot, const arr& ts) const;
   
   //-- the rest are all matrix methods, using the basis mastix for fixed grid of size T
   
@@ -67,6 +76,8 @@ struct Path : Spline {
   
   arr getPosition(double t) const;
   arr getVelocity(double t) const;
+  /// positions, velocities, and accelerations at all times ts (any may be NoArr)
+  void getStates(arr& pos, arr& vel, arr& acc, const arr& ts) const { eval(pos, vel, acc, ts); }
   
   /// use this when your endeffector moved differently than expected, but the goal remains fixed
   void transform_CurrentBecomes_EndFixed(const arr& current, double t);
@@ -56,12 +56,83 @@ const bool lapackSupported=true;
 #else
 const bool lapackSupported=false;
 #endif
-uint64_t globalMemoryTotal=0, globalMemoryBound=1ull<<30; //this is 1GB
+std::atomic<uint64_t> globalMemoryTotal(0);
+uint64_t globalMemoryBound=1ull<<30; //this is 1GB
 bool globalMemoryStrict=false;
 const char* arrayElemsep=" ";
 const char* arrayLinesep="\n ";
 const char* arrayBrackets="  ";
 
+/// add (or subtract) bytes to the global memory count; warns or throws when exceeding globalMemoryBound
+void globalMemoryAccount(int64_t bytes) {
+  if(!bytes) return;
+  uint64_t total = globalMemoryTotal.fetch_add((uint64_t)bytes) + (uint64_t)bytes;
+  if(bytes>0 && total>globalMemoryBound) { //helpers to limit global memory (e.g. to avoid crashing a machine)
+    if(globalMemoryStrict) {
+      HALT("strict memory limit exceeded: allocating " <<(bytes>>20) <<"MB (total=" <<(total>>20) <<"M, bound=" <<(globalMemoryBound>>20) <<"M)");
+    } else if(bytes>>20 || total-bytes<=globalMemoryBound) { //just give a warning
+      RAI_MSG("allocating " <<(bytes>>20) <<"MB (total=" <<(total>>20) <<"M, bound=" <<(globalMemoryBound>>20) <<"M)");
+    }
+  }
+}
+
+//===========================================================================
+//
+// thread-local pool of recycled array memory blocks
+//
+
+/// blocks have power-of-two sizes (64B..16MB), with a 16 byte header holding the size class and the free list link
+struct ArrayPool {
+  enum { minClass=6, maxClass=24, header=16 };
+  int depth=0;
+  char* freeList[maxClass+1];
+  ArrayPool() { memset(freeList, 0, sizeof(freeList)); }
+  ~ArrayPool() { release(); }
+  void release() {
+    for(uint c=minClass; c<=maxClass; c++) while(freeList[c]) {
+        char *b=freeList[c];
+        freeList[c] = *(char**)(b+8);
+        ::free(b);
+      }
+  }
+};
+
+static thread_local ArrayPool arrayPool;
+
+ArrayPoolScope::ArrayPoolScope() { arrayPool.depth++; }
+
+ArrayPoolScope::~ArrayPoolScope() {
+  arrayPool.depth--;
+  if(!arrayPool.depth) arrayPool.release();
+}
+
+void* arrayPoolAlloc(uint64_t bytes, uint64_t& capacity) {
+  if(!arrayPool.depth) return NULL;
+  uint c=ArrayPool::minClass;
+  while(c<=ArrayPool::maxClass && (1ull<<c) < bytes+ArrayPool::header) c++;
+  if(c>ArrayPool::maxClass) return NULL;
+  char *b=arrayPool.freeList[c];
+  if(b) arrayPool.freeList[c] = *(char**)(b+8);
+  else {
+    b = (char*)::malloc(1ull<<c);
+    if(!b) HALT("memory allocation failed! Wanted size = " <<(1ull<<c) <<"bytes");
+    *(uint32_t*)b = c;
+  }
+  capacity = (1ull<<c) - ArrayPool::header;
+  return b+ArrayPool::header;
+}
+
+void arrayPoolFree(void* block) {
+  char *b=(char*)block - ArrayPool::header;
+  uint c=*(uint32_t*)b;
+  if(arrayPool.depth) { //recycle (also blocks allocated by other threads: all are plain malloc blocks)
+    *(char**)(b+8) = arrayPool.freeList[c];
+    arrayPool.freeList[c] = b;
+  } else {
+    ::free(b);
+  }
+}
+
 //===========================================================================
 }
 
@@ -1852,6 +1923,17 @@ RowShifted::RowShifted(arr& X, RowShifted &aux):
   Z.special=this;
 }
 
+RowShifted::RowShifted(arr& X, RowShifted&& aux):
+  Z(X),
+  real_d1(aux.real_d1),
+  rowShift(std::move(aux.rowShift)),
+  rowLen(std::move(aux.rowLen)),
+  colPatches(std::move(aux.colPatches)),
+  symmetric(aux.symmetric) {
+  type = SpecialArray::RowShiftedST;
+  Z.special=this;
+}
+
 RowShifted *makeRowShifted(arr& Z, uint d0, uint pack_d1, uint real_d1) {
   RowShifted *Zaux;
   if(!Z.special) {
@@ -2136,12 +2218,28 @@ SparseMatrix::SparseMatrix(arr& _Z, SparseMatrix& s) : Z(_Z) {
   elems = s.elems;
 }
 
+SparseMatrix::SparseMatrix(arr& _Z, SparseMatrix&& s) : Z(_Z) {
+  CHECK(isNotSpecial(_Z), "only once yet");
+  type = SpecialArray::sparseMatrixST;
+  Z.special = this;
+  elems = std::move(s.elems);
+  cols = std::move(s.cols);
+  rows = std::move(s.rows);
+}
+
 SparseVector::SparseVector(arr& _Z) : Z(_Z) {
   CHECK(isNotSpecial(_Z), "only once yet");
   type=sparseVectorST;
   Z.special = this;
 }
 
+SparseVector::SparseVector(arr& _Z, SparseVector&& s) : Z(_Z) {
+  CHECK(isNotSpecial(_Z), "only once yet");
+  type=sparseVectorST;
+  Z.special = this;
+  elems = std::move(s.elems);
+}
+
 /// return fraction of non-zeros in the array
 template<> double Array<double>::sparsity() {
   uint i, m=0;
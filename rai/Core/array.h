@@ -20,6 +20,7 @@
 #include <functional>
 #include <memory>
 #include <vector>
+#include <atomic>
 
 //-- don't require previously defined iterators
 #define for_list(Type, it, X)     Type *it=NULL; for(uint it##_COUNT=0;   it##_COUNT<X.N && ((it=X(it##_COUNT)) || true); it##_COUNT++)
@@ -42,8 +43,22 @@ struct Serializable{
 namespace rai {
 extern bool useLapack;
 extern const bool lapackSupported;
-extern uint64_t globalMemoryTotal, globalMemoryBound;
+extern std::atomic<uint64_t> globalMemoryTotal; ///< only counted with RAI_GLOBALMEM (thread-safe)
+extern uint64_t globalMemoryBound;
 extern bool globalMemoryStrict;
+void globalMemoryAccount(int64_t bytes);
+
+/** While an ArrayPoolScope is alive on a thread, Arrays of trivial element types that need new
+    memory on that thread take it from a thread-local pool of recycled blocks instead of the global
+    allocator, and return it there when freed. The cached blocks are released in bulk at the end of the
+    outermost scope; arrays that outlive the scope keep their blocks (freed individually later), so this
+    is safe to wrap around any inner loop (e.g., OptNewton::step). */
+struct ArrayPoolScope {
+  ArrayPoolScope();
+  ~ArrayPoolScope();
+};
+void* arrayPoolAlloc(uint64_t bytes, uint64_t& capacity); ///< NULL if no ArrayPoolScope is active on this thread
+void arrayPoolFree(void* block);
 extern const char* arrayElemsep;
 extern const char* arrayLinesep;
 extern const char* arrayBrackets;
@@ -84,6 +99,8 @@ template<class T> struct Array : std::vector<T>, Serializable {
   uint *d;  ///< pointer to dimensions (for nd<=3 points to d0)
   uint M;   ///< size of actually allocated memory (may be greater than N)
   bool reference; ///< true if this refers to some external memory
+  bool local;     ///< true if p is the inline buffer of a SmallArray or mapped file memory (spills to the heap when exceeded), or a pool block
+  bool pooled;    ///< true if p is a block of this thread's array pool (see ArrayPoolScope)
   
   static int  sizeT;   ///< constant for each type T: stores the sizeof(T)
   static char memMove; ///< constant for each type T: decides whether memmove can be used instead of individual copies
@@ -97,6 +114,7 @@ template<class T> struct Array : std::vector<T>, Serializable {
   /// @name constructors
   Array();
   Array(const Array<T>& a);                 //copy constructor
+  Array(Array<T>&& a);                      //move constructor
   explicit Array(uint D0);
   explicit Array(uint D0, uint D1);
   explicit Array(uint D0, uint D1, uint D2);
@@ -114,6 +132,7 @@ template<class T> struct Array : std::vector<T>, Serializable {
   Array<T>& operator=(std::initializer_list<T> values);
   Array<T>& operator=(const T& v);
   Array<T>& operator=(const Array<T>& a);
+  Array<T>& operator=(Array<T>&& a);
   Array<T>& operator=(const std::vector<T>& values);
   
   /// @name iterators
@@ -309,6 +328,8 @@ template<class T> struct Array : std::vector<T>, Serializable {
   void anticipateMEM(uint Mforce) { resizeMEM(N, true, Mforce); if(!nd) nd=1; }
   void freeMEM();
   void resetD();
+  void setLocalMEM(T *buffer, uint capacity, uint n=0);
+  uint64_t ownedMEM() const;
 //  void init();
 
   /// @name serialization
@@ -317,6 +338,35 @@ template<class T> struct Array : std::vector<T>, Serializable {
   uint serial_decode(char* data, uint data_size);
 };
 
+//===========================================================================
+///
+/// @name small and fixed-size arrays
+/// @{
+
+/** An Array with inline storage for up to S elements: no heap allocation as long as N<=S
+    (beyond that it transparently spills to the heap). It is an Array<T>, so it can be passed
+    to any arr& API without copies -- use it for kinematics temporaries (3-vectors, quaternions,
+    3x3 rotations, 6x6 spatial matrices). */
+template<class T, uint S> struct SmallArray : Array<T> {
+  T buffer[S];
+  SmallArray() { this->setLocalMEM(buffer, S); }
+  SmallArray(const SmallArray<T,S>& a) : SmallArray() { Array<T>::operator=(a); }
+  SmallArray(const Array<T>& a) : SmallArray() { Array<T>::operator=(a); }
+  SmallArray(std::initializer_list<T> values) : SmallArray() { Array<T>::operator=(values); }
+  SmallArray<T,S>& operator=(const SmallArray<T,S>& a) { Array<T>::operator=(a); return *this; }
+  using Array<T>::operator=;
+};
+
+/// a SmallArray initialized with compile-time dimensions D0 (x D1), all zero
+template<class T, uint D0, uint D1=0> struct FixedArray : SmallArray<T, (D1?D0*D1:D0)> {
+  FixedArray() { if(D1) this->resize(D0, D1); else this->resize(D0); }
+  FixedArray(const Array<T>& a) { Array<T>::operator=(a); }
+  FixedArray(std::initializer_list<T> values);
+  using Array<T>::operator=;
+};
+
+/// @}
+
 //===========================================================================
 ///
 /// @name alternative iterators
@@ -470,6 +520,11 @@ namespace rai { struct String; }
 typedef rai::Array<rai::String> StringA;
 typedef rai::Array<StringA> StringAA;
 typedef rai::Array<rai::String*> StringL;
+typedef rai::FixedArray<double, 3>    arr3;
+typedef rai::FixedArray<double, 4>    arr4;
+typedef rai::FixedArray<double, 6>    arr6;
+typedef rai::FixedArray<double, 3, 3> arr33;
+typedef rai::FixedArray<double, 6, 6> arr66;
 
 //===========================================================================
 /// @}
@@ -920,6 +975,7 @@ struct RowShifted : SpecialArray {
   
   RowShifted(arr& X);
   RowShifted(arr& X, RowShifted &aux);
+  RowShifted(arr& X, RowShifted&& aux);
   ~RowShifted();
   double elem(uint i, uint j); //TODO rename to 'elem'
   void reshift(); //shift all cols to start with non-zeros
@@ -943,6 +999,7 @@ struct SparseVector: SpecialArray {
   arr& Z;      ///< references the array itself
   intA elems;  ///< for every non-zero (in memory order), the index
   SparseVector(arr& _Z);
+  SparseVector(arr& _Z, SparseVector&& s);
   void resize(uint d0, uint n);
   double& entry(uint i, uint k);
   void setFromDense(const arr& x);
@@ -957,6 +1014,7 @@ struct SparseMatrix : SpecialArray {
 
   SparseMatrix(arr& _Z);
   SparseMatrix(arr& _Z, SparseMatrix& s);
+  SparseMatrix(arr& _Z, SparseMatrix&& s);
   void resize(uint d0, uint d1, uint n);
   void reshape(uint d0, uint d1);
   double& entry(uint i,uint j,uint k);
@@ -14,6 +14,7 @@
 #include <math.h>
 #include <algorithm>
 #include <sstream>
+#include <type_traits>
 
 #define maxRank 30
 /** @brief if flexiMem is true (which is default!) the resize method will
@@ -48,6 +49,7 @@ template<class T> int rai::Array<T>::sizeT=-1;
 /// standard constructor -- this becomes an empty array
 template<class T> rai::Array<T>::Array():d(&d0) {
   reference=false;
+  local=pooled=false;
   if(sizeT==-1) sizeT=sizeof(T);
   if(memMove==(char)-1) {
     memMove=0;
@@ -72,6 +74,9 @@ template<class T> rai::Array<T>::Array():d(&d0) {
 /// copy constructor
 template<class T> rai::Array<T>::Array(const rai::Array<T>& a):Array() { operator=(a); }
 
+/// move constructor (see move operator)
+template<class T> rai::Array<T>::Array(rai::Array<T>&& a):Array() { operator=(std::move(a)); }
+
 /// constructor with resize
 template<class T> rai::Array<T>::Array(uint i):Array() { resize(i); }
 
@@ -107,6 +112,14 @@ template<class T> rai::Array<T>::Array(SpecialArray* _special) : Array(){ specia
 template<class T> rai::Array<T>::~Array() {
   if(special) { delete special; special=NULL; }
   freeMEM();
+#ifdef RAI_GLOBALMEM
+  globalMemoryAccount(-int64_t(ownedMEM()));
+#endif
+  if(local) { //the inline buffer is not owned by the vector base
+    vec_type::_M_impl._M_start = NULL;
+    vec_type::_M_impl._M_finish = NULL;
+    vec_type::_M_impl._M_end_of_storage = NULL;
+  }
 }
 
 template<class T> bool rai::Array<T>::operator!() const {
@@ -342,19 +355,84 @@ template<class T> void rai::Array<T>::freeMEM() {
 }
 
 #else
+namespace rai {
+/// raw block moves for the pool path; only instantiated for trivial types, for which zeros are T()
+template<class T, bool trivial=std::is_trivial<T>::value> struct ArrayPoolMove {
+  enum { enabled=false };
+  static void move(T*, const T*, uint, uint) {}
+};
+template<class T> struct ArrayPoolMove<T, true> {
+  enum { enabled=true };
+  static void move(T* block, const T* p, uint n0, uint n) {
+    if(n0) memmove(block, p, sizeof(T)*n0);
+    memset(block+n0, 0, sizeof(T)*(n-n0));
+  }
+};
+}
+
 /// allocate memory (maybe using \ref flexiMem)
 template<class T> void rai::Array<T>::resizeMEM(uint n, bool copy, int Mforce) {
   if(n==N) return;
   CHECK(!reference, "resize of a reference (e.g. subarray) is not allowed! (only a resize without changing memory size)");
-  vec_type::resize(n);
-  p = vec_type::_M_impl._M_start;
+  if(local && n<=M) { //fits into the inline buffer or pool block
+    for(uint i=N; i<n; i++) p[i]=T();
+    N = n;
+    vec_type::_M_impl._M_finish = p+N;
+    return;
+  }
+#ifdef RAI_GLOBALMEM
+  uint64_t memOld = ownedMEM();
+#endif
+  T *block=NULL;
+  uint64_t capacity=0;
+  if(n>M && ArrayPoolMove<T>::enabled) block = (T*)arrayPoolAlloc(uint64_t(n)*sizeT, capacity);
+  if(block) { //take a block from this thread's pool (see ArrayPoolScope)
+    ArrayPoolMove<T>::move(block, p, N<n?N:n, n);
+    if(pooled) arrayPoolFree(p);
+    else if(!local) vec_type().swap(*this); //release the vector's memory
+    local=pooled=true;
+    p=block;
+    M=capacity/sizeT;
+    vec_type::_M_impl._M_start = p;
+    vec_type::_M_impl._M_end_of_storage = p+M;
+  } else if(local) { //spill to the heap
+    T *buffer=p;
+    uint n0=N;
+    vec_type::_M_impl._M_start = NULL;
+    vec_type::_M_impl._M_finish = NULL;
+    vec_type::_M_impl._M_end_of_storage = NULL;
+    vec_type::resize(n);
+    for(uint i=0; i<n0; i++) vec_type::_M_impl._M_start[i]=buffer[i];
+    if(pooled) arrayPoolFree(buffer);
+    local=pooled=false;
+  } else {
+    vec_type::resize(n);
+  }
+  if(!block) {
+    p = vec_type::_M_impl._M_start;
+    M = vec_type::_M_impl._M_end_of_storage - p;
+  }
   N = n;
-  M = vec_type::_M_impl._M_end_of_storage - p;
+  vec_type::_M_impl._M_finish = p+N;
+#ifdef RAI_GLOBALMEM
+  globalMemoryAccount(int64_t(ownedMEM())-int64_t(memOld));
+#endif
 }
 
 /// free all memory and reset all pointers and sizes
 template<class T> void rai::Array<T>::freeMEM() {
-  if(!reference) {
+  if(local && !pooled) { //keep the inline buffer
+    vec_type::_M_impl._M_finish = p;
+    if(d && d!=&d0) { delete[] d; d=NULL; }
+    N=nd=d0=d1=d2=0;
+    d=&d0;
+    return;
+  }
+#ifdef RAI_GLOBALMEM
+  uint64_t memOld = ownedMEM();
+#endif
+  if(pooled) arrayPoolFree(p);
+  if(!reference && !local) {
     vec_type::clear();
   } else {
     vec_type::_M_impl._M_start = NULL;
@@ -365,7 +443,17 @@ template<class T> void rai::Array<T>::freeMEM() {
   p=NULL;
   M=N=nd=d0=d1=d2=0;
   d=&d0;
-  reference=false;
+  reference=local=pooled=false;
+#ifdef RAI_GLOBALMEM
+  globalMemoryAccount(int64_t(ownedMEM())-int64_t(memOld));
+#endif
+}
+
+/// bytes of memory owned by this array (the vector's capacity or the pool block; not inline buffers or references)
+template<class T> uint64_t rai::Array<T>::ownedMEM() const {
+  if(pooled) return uint64_t(M)*sizeT;
+  if(local || reference) return 0;
+  return uint64_t(vec_type::capacity())*sizeT;
 }
 #endif
 
@@ -384,6 +472,37 @@ template<class T> rai::Array<T>& rai::Array<T>::dereference() {
   return *this;
 }
 
+/// let this use external memory until it needs more than capacity elements: the inline buffer of a SmallArray,
+/// or mapped file memory whose first n elements are the content (see Mesh::readBinary); NULL drops such memory again
+template<class T> void rai::Array<T>::setLocalMEM(T *buffer, uint capacity, uint n) {
+  CHECK(!N && !reference && !pooled, "can only set the local memory of an empty array");
+  CHECK_LE(n, capacity, "");
+#ifdef RAI_GLOBALMEM
+  uint64_t memOld = ownedMEM();
+#endif
+  if(!local) vec_type().swap(*this); //release the vector's memory
+  resetD();
+  local = (buffer!=NULL);
+  p=buffer;
+  M=capacity;
+  N=d0=n;
+  nd=(n?1:0);
+  d1=d2=0;
+  vec_type::_M_impl._M_start = p;
+  vec_type::_M_impl._M_finish = p+N;
+  vec_type::_M_impl._M_end_of_storage = p+M;
+#ifdef RAI_GLOBALMEM
+  globalMemoryAccount(int64_t(ownedMEM())-int64_t(memOld));
+#endif
+}
+
+/// initialization via {1., 2., 3., ...} lists, which must match the fixed dimensions
+template<class T, uint D0, uint D1> rai::FixedArray<T, D0, D1>::FixedArray(std::initializer_list<T> values) : FixedArray() {
+  CHECK_EQ(values.size(), this->N, "wrong number of values for a fixed-size array");
+  uint i=0;
+  for(const T& t:values) this->p[i++]=t;
+}
+
 /// reset the dimensionality pointer d to point to &d0
 template<class T> void rai::Array<T>::resetD() {
   if(d && d!=&d0) { delete[] d; d=NULL; }
@@ -403,8 +522,15 @@ template<class T> T& rai::Array<T>::append() {
 
 /// append an element to the array -- the array becomes 1D!
 template<class T> T& rai::Array<T>::append(const T& x) {
+  if(local) { T& y=append(); y=x; return y; }
   reshape(N);
+#ifdef RAI_GLOBALMEM
+  uint64_t memOld = ownedMEM();
+#endif
   vec_type::push_back(x);
+#ifdef RAI_GLOBALMEM
+  globalMemoryAccount(int64_t(ownedMEM())-int64_t(memOld));
+#endif
   p = vec_type::_M_impl._M_start;
   d0 = N = vec_type::size();
   M = vec_type::_M_impl._M_end_of_storage - p;
@@ -1108,7 +1234,7 @@ template<class T> T** rai::Array<T>::getCarray() const {
 /// makes this array a reference to the C buffer
 template<class T> void rai::Array<T>::referTo(const T *buffer, uint n) {
   freeMEM();
-  reference=true;
+  reference=true; local=false; M=0;
   nd=1; d0=n; d1=d2=0; N=n;
   p=(T*)buffer;
   vec_type::_M_impl._M_start = p;
@@ -1185,6 +1311,35 @@ template<class T> rai::Array<T>& rai::Array<T>::operator=(const rai::Array<T>& a
   return *this;
 }
 
+/// move operator: takes over the memory (and a RowShifted/sparse payload) of a, which becomes empty;
+/// copies instead if this or a is a reference (e.g., assignment into a subarray, or from a row x[i]) or a SmallArray
+template<class T> rai::Array<T>& rai::Array<T>::operator=(rai::Array<T>&& a) {
+  CHECK(this!=&a, "never do this!!!");
+  bool movableSpecial = isNotSpecial(a) || isRowShifted(a) || isSparseMatrix(a) || isSparseVector(a);
+  if(reference || a.reference || (local && !pooled) || (a.local && !a.pooled) || !movableSpecial) return operator=((const rai::Array<T>&)a);
+  if(special) { delete special; special=NULL; }
+  freeMEM();
+#ifdef RAI_GLOBALMEM
+  globalMemoryAccount(-int64_t(ownedMEM())); //the vector's cleared capacity is released by the move
+#endif
+  (vec_type&)*this = std::move((vec_type&)a);
+  local=pooled=a.pooled;
+  a.local=a.pooled=false;
+  p=a.p; N=a.N; M=a.M; nd=a.nd; d0=a.d0; d1=a.d1; d2=a.d2;
+  if(a.d!=&a.d0) { d=a.d; a.d=&a.d0; }
+  a.p=NULL;
+  a.N=a.M=a.nd=a.d0=a.d1=a.d2=0;
+  if(!isNotSpecial(a)) {
+    CHECK(typeid(T) == typeid(double), "");
+    if(isRowShifted(a)) new RowShifted(*((arr*)this), std::move(*((RowShifted*)a.special)));
+    if(isSparseMatrix(a)) new SparseMatrix(*((arr*)this), std::move(*((SparseMatrix*)a.special)));
+    if(isSparseVector(a)) new SparseVector(*((arr*)this), std::move(*((SparseVector*)a.special)));
+    delete a.special;
+    a.special=NULL;
+  }
+  return *this;
+}
+
 /// copy operator
 template<class T> rai::Array<T>& rai::Array<T>::operator=(const std::vector<T>& a) {
   setCarray(&a.front(), a.size());
@@ -1383,7 +1538,7 @@ template<class T> void rai::Array<T>::copyInto2D(T **buffer) const {
 /// make this array a reference to the array \c a
 template<class T> void rai::Array<T>::referTo(const rai::Array<T>& a) {
   freeMEM();
-  reference=true; memMove=a.memMove;
+  reference=true; local=false; M=0; memMove=a.memMove;
   N=a.N; nd=a.nd; d0=a.d0; d1=a.d1; d2=a.d2;
   p=a.p;
   vec_type::_M_impl._M_start = p;
@@ -1396,7 +1551,7 @@ template<class T> void rai::Array<T>::referToRange(const rai::Array<T>& a, int i
   CHECK_LE(a.nd, 3, "not implemented yet");
   freeMEM();
   resetD();
-  reference=true; memMove=a.memMove;
+  reference=true; local=false; M=0; memMove=a.memMove;
   if(i<0) i+=a.d0;
   if(I<0) I+=a.d0;
   if(i>I) return;
@@ -1424,7 +1579,7 @@ template<class T> void rai::Array<T>::referToRange(const Array<T>& a, int i, int
   CHECK_LE(a.nd, 3, "not implemented yet");
   freeMEM();
   resetD();
-  reference=true; memMove=a.memMove;
+  reference=true; local=false; M=0; memMove=a.memMove;
   if(i<0) i+=a.d0;
   if(j<0) j+=a.d1;
   if(J<0) J+=a.d1;
@@ -1450,7 +1605,7 @@ template<class T> void rai::Array<T>::referToRange(const Array<T>& a, int i, int
   CHECK_LE(a.nd, 3, "not implemented yet");
   freeMEM();
   resetD();
-  reference=true; memMove=a.memMove;
+  reference=true; local=false; M=0; memMove=a.memMove;
   if(i<0) i+=a.d0;
   if(j<0) j+=a.d1;
   if(k<0) k+=a.d2;
@@ -1476,7 +1631,7 @@ template<class T> void rai::Array<T>::referToDim(const rai::Array<T>& a, int i)
   
   CHECK(i>=0 && i<(int)a.d0, "SubDim range error (" <<i <<"<" <<a.d0 <<")");
   freeMEM();
-  reference=true; memMove=a.memMove;
+  reference=true; local=false; M=0; memMove=a.memMove;
   if(a.nd==2) {
     nd=1; d0=a.d1; d1=d2=0; N=d0;
   }
@@ -1499,7 +1654,7 @@ template<class T> void rai::Array<T>::referToDim(const rai::Array<T>& a, uint i,
   CHECK(a.nd>2, "can't create subsubarray of array less than 3 dimensions");
   CHECK(i<a.d0 && j<a.d1, "SubDim range error (" <<i <<"<" <<a.d0 <<", " <<j <<"<" <<a.d1 <<")");
   freeMEM();
-  reference=true; memMove=a.memMove;
+  reference=true; local=false; M=0; memMove=a.memMove;
   if(a.nd==3) {
     nd=1; d0=a.d2; d1=0; d2=0; N=d0;
     p=&a(i, j, 0);
@@ -1516,7 +1671,7 @@ template<class T> void rai::Array<T>::referToDim(const rai::Array<T>& a, uint i,
   CHECK(a.nd>3, "can't create subsubarray of array less than 3 dimensions");
   CHECK(i<a.d0 && j<a.d1 && k<a.d2, "SubDim range error (" <<i <<"<" <<a.d0 <<", " <<j <<"<" <<a.d1 <<", " <<k <<"<" <<a.d2 << ")");
   freeMEM();
-  reference=true; memMove=a.memMove;
+  reference=true; local=false; M=0; memMove=a.memMove;
   if(a.nd==4) {
     nd=1; d0=a.d[3]; d1=d2=0; N=d0;
   }
@@ -1559,8 +1714,11 @@ template<class T> void rai::Array<T>::swap(Array<T>& a) {
   HALT("vec not done yet");
 #else
     CHECK(!reference && !a.reference, "NIY for references");
+    CHECK((!local || pooled) && (!a.local || a.pooled), "NIY for small arrays");
     CHECK(nd<=3 && a.nd<=3, "only for 1D");
     std::swap((vec_type&)*this, (vec_type&)a);
+    std::swap(local, a.local);
+    std::swap(pooled, a.pooled);
 
     T* p_tmp = p;
     p=a.p;
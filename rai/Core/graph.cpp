@@ -7,6 +7,8 @@
     --------------------------------------------------------------  */
 
 #include <map>
+#include <unordered_map>
+#include <mutex>
 
 #ifdef RAI_JSON
 #  include <jsoncpp/json/json.h>
@@ -18,6 +20,55 @@
 
 #define DEBUG(x) //x
 
+//===========================================================================
+//
+// key index: key hash -> nodes carrying that key, in graph order. It covers the
+// first N nodes of the graph; appended nodes are added on the next lookup (so
+// that keys set right after creation are seen), deleted nodes are removed
+// immediately, using the hashes they were indexed under (so a node whose keys
+// changed leaves no dangling entry). Candidates are always confirmed with
+// Node::matches. Graphs smaller than keyIndexMinN are scanned linearly.
+//
+// Concurrent finds on an unchanged graph are allowed (e.g. getParameter on the
+// registry from several threads): building, extending and deleting the index
+// happen under keyIndexMutex.
+//
+
+static const uint keyIndexMinN = 32;
+static std::mutex keyIndexMutex;
+
+static uint64_t keyHash(const char *p, uint n) {
+  uint64_t h = 14695981039346656037ull;
+  for(uint i=0; i<n; i++) { h ^= (unsigned char)p[i]; h *= 1099511628211ull; }
+  return h;
+}
+
+struct sGraphKeyIndex {
+  std::unordered_map<uint64_t, NodeL> nodes;
+  std::unordered_map<Node*, std::vector<uint64_t>> hashes; ///< the hashes each indexed node was added under
+  uint N=0;
+  
+  void add(Node *n) {
+    std::vector<uint64_t>& H = hashes[n];
+    for(const rai::String& k:n->keys) {
+      uint64_t h = keyHash(k.p, k.N);
+      NodeL& L = nodes[h];
+      if(!L.N || L.last()!=n) { L.append(n); H.push_back(h); } //a node may carry the same key twice
+    }
+  }
+  
+  void remove(Node *n) {
+    auto it = hashes.find(n);
+    if(it==hashes.end()) return; //not indexed yet
+    for(uint64_t h:it->second) {
+      auto L = nodes.find(h);
+      if(L!=nodes.end()) L->second.removeValue(n, false);
+    }
+    hashes.erase(it);
+    N--;
+  }
+};
+
 Graph __NoGraph;
 Graph& NoGraph = __NoGraph;
 
@@ -87,6 +138,10 @@ Node::Node(const std::type_info& _type, void* _value_ptr, Graph& _container, con
 }
 
 Node::~Node() {
+  if(container.keyIndex) {
+    std::lock_guard<std::mutex> lock(keyIndexMutex);
+    if(container.keyIndex) container.keyIndex->remove(this);
+  }
   if(container.isDoubleLinked) while(parentOf.N) parentOf.last()->removeParent(this);
   if(numChildren) LOG(-2) <<"It is not allowed to delete nodes that still have children";
   while(parents.N) removeParent(parents.last());
@@ -262,11 +317,34 @@ Graph::~Graph() {
   clear();
 }
 
+void Graph::invalidateKeyIndex() const {
+  if(!keyIndex) return;
+  std::lock_guard<std::mutex> lock(keyIndexMutex);
+  if(keyIndex) { delete keyIndex; keyIndex=NULL; }
+}
+
+/// returns the nodes that carry the rarest of the keys, in graph order, or NULL if the graph is to be scanned
+const NodeL* Graph::keyIndexCandidates(const StringA& keys) const {
+  static const NodeL none;
+  if(!keys.N || N<keyIndexMinN) return NULL;
+  std::lock_guard<std::mutex> lock(keyIndexMutex);
+  if(!keyIndex) keyIndex = new sGraphKeyIndex;
+  for(; keyIndex->N<N; keyIndex->N++) keyIndex->add(elem(keyIndex->N));
+  const NodeL *candidates=NULL;
+  for(const rai::String& k:keys) {
+    auto it = keyIndex->nodes.find(keyHash(k.p, k.N));
+    if(it==keyIndex->nodes.end()) return &none;
+    if(!candidates || it->second.N<candidates->N) candidates = &it->second;
+  }
+  return candidates;
+}
+
 bool Graph::operator!() const {
   return this==&__NoGraph;
 }
 
 void Graph::clear() {
+  invalidateKeyIndex();
   if(ri) { delete ri; ri=NULL; }
   if(pi) { delete pi; pi=NULL; }
   DEBUG(checkConsistency();)
@@ -322,7 +400,8 @@ void Graph::appendDict(const std::map<std::string, std::string>& dict) {
 }
 
 Node* Graph::findNode(const StringA& keys, bool recurseUp, bool recurseDown) const {
-  for(Node* n: (*this)) if(n->matches(keys)) return n;
+  const NodeL *candidates = keyIndexCandidates(keys);
+  for(Node* n: (candidates ? *candidates : (const NodeL&)*this)) if(n->matches(keys)) return n;
   Node* ret=NULL;
   if(recurseUp && isNodeOfGraph) ret = isNodeOfGraph->container.findNode(keys, true, false);
   if(ret) return ret;
@@ -334,7 +413,8 @@ Node* Graph::findNode(const StringA& keys, bool recurseUp, bool recurseDown) con
 }
 
 Node* Graph::findNodeOfType(const std::type_info& type, const StringA& keys, bool recurseUp, bool recurseDown) const {
-  for(Node* n: (*this)) if(n->type==type && n->matches(keys)) return n;
+  const NodeL *candidates = keyIndexCandidates(keys);
+  for(Node* n: (candidates ? *candidates : (const NodeL&)*this)) if(n->type==type && n->matches(keys)) return n;
   Node* ret=NULL;
   if(recurseUp && isNodeOfGraph) ret = isNodeOfGraph->container.findNodeOfType(type, keys, true, false);
   if(ret) return ret;
@@ -347,7 +427,8 @@ Node* Graph::findNodeOfType(const std::type_info& type, const StringA& keys, boo
 
 NodeL Graph::findNodes(const StringA& keys, bool recurseUp, bool recurseDown) const {
   NodeL ret;
-  for(Node *n: (*this)) if(n->matches(keys)) ret.append(n);
+  const NodeL *candidates = keyIndexCandidates(keys);
+  for(Node *n: (candidates ? *candidates : (const NodeL&)*this)) if(n->matches(keys)) ret.append(n);
   if(recurseUp && isNodeOfGraph) ret.append(isNodeOfGraph->container.findNodes(keys, true, false));
   if(recurseDown) for(Node *n: (*this)) if(n->isGraph()) ret.append(n->graph().findNodes(keys, false, true));
   return ret;
@@ -355,7 +436,8 @@ NodeL Graph::findNodes(const StringA& keys, bool recurseUp, bool recurseDown) co
 
 NodeL Graph::findNodesOfType(const std::type_info& type, const StringA& keys, bool recurseUp, bool recurseDown) const {
   NodeL ret;
-  for(Node *n: (*this)) if(n->type==type && n->matches(keys)) ret.append(n);
+  const NodeL *candidates = keyIndexCandidates(keys);
+  for(Node *n: (candidates ? *candidates : (const NodeL&)*this)) if(n->type==type && n->matches(keys)) ret.append(n);
   if(recurseUp && isNodeOfGraph) ret.append(isNodeOfGraph->container.findNodesOfType(type, keys, true, false));
   if(recurseDown) for(Node *n: (*this)) if(n->isGraph()) ret.append(n->graph().findNodesOfType(type, keys, false, true));
   return ret;
@@ -582,6 +664,7 @@ void Graph::read(std::istream& is, bool parseInfo) {
       if(namePrefix.N){
         for(uint i=Nbefore;i<N;i++) elem(i)->keys.last().prepend(namePrefix);
         namePrefix.clear();
+        invalidateKeyIndex();
       }
       n->get<rai::FileToken>().cd_start();
       delete n; n=NULL;
@@ -592,6 +675,7 @@ void Graph::read(std::istream& is, bool parseInfo) {
       n->get<rai::FileToken>().cd_file();
     } else if(n->keys.N>0 && n->keys.first()=="Delete") {
       n->keys.remove(0);
+      invalidateKeyIndex();
       NodeL dels = getNodes(n->keys);
       for(Node* d: dels) { delete d; d=NULL; }
     }
@@ -605,6 +689,7 @@ void Graph::read(std::istream& is, bool parseInfo) {
   for(Node *ed:edits) {
     CHECK_EQ(ed->keys.first(), "Edit" , "an edit node needs Edit as first key");
     ed->keys.remove(0);
+    invalidateKeyIndex();
     edit(ed);
   }
   
@@ -1064,6 +1149,7 @@ void Graph::sortByDotOrder() {
     }
   }
   permuteInv(perm);
+  invalidateKeyIndex();
   for_list(Node, it2, list()) it2->index=it2_COUNT;
 }
 
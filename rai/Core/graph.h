@@ -89,6 +89,7 @@ struct Graph : NodeL {
   Node *isNodeOfGraph; ///< THIS is a subgraph of another graph; isNodeOfGraph points to the node that equals THIS graph
   bool isIndexed=true;
   bool isDoubleLinked=true;
+  mutable struct sGraphKeyIndex *keyIndex=NULL; ///< lazily built key->nodes hash index, used by the find methods on larger graphs
   
   GraphEditCallbackL callbacks; ///< list of callbacks that are informed about creation and destruction of nodes
   
@@ -129,6 +130,7 @@ struct Graph : NodeL {
   NodeL findNodes(const StringA& keys=StringA(), bool recurseUp=false, bool recurseDown=false) const;
   Node* findNodeOfType(const std::type_info& type, const StringA& keys=StringA(), bool recurseUp=false, bool recurseDown=false) const;
   NodeL findNodesOfType(const std::type_info& type, const StringA& keys=StringA(), bool recurseUp=false, bool recurseDown=false) const;
+  void invalidateKeyIndex() const; ///< call after changing the keys of nodes that are already in the graph (new nodes are indexed automatically)
   
   //-- get nodes
   Node* operator[](const char *key) const { return findNode({key}); } ///< returns NULL if not found
@@ -190,6 +192,7 @@ struct Graph : NodeL {
   //private:
   friend struct Node;
   uint index(bool subKVG=false, uint start=0);
+  const NodeL* keyIndexCandidates(const StringA& keys) const;
 
 };
 stdPipes(Graph)
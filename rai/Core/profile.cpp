@@ -0,0 +1,210 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2017 Marc Toussaint
+    email: marc.toussaint@informatik.uni-stuttgart.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "profile.h"
+#include "util.h"
+#include <chrono>
+#include <cxxabi.h>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace rai {
+
+std::atomic<int> profileState(-1);
+
+namespace {
+
+struct ProfileEntry { uint64_t count=0; double time=0., max=0.; };
+struct ProfileEvent { std::string name; double start, dur; };
+
+struct ProfileBuffer {
+  std::mutex mutex; //only contended while a report merges the buffers
+  uint tid;
+  std::map<std::string, ProfileEntry> entries;
+  std::vector<ProfileEvent> events;
+  uint64_t droppedEvents=0;
+};
+
+struct ProfileRegistry {
+  std::mutex mutex;
+  std::list<ProfileBuffer> buffers; //a list, so that buffers keep their address; they outlive their threads
+  std::string traceFile;
+  uint64_t traceMax=1000000; ///< max trace events per thread; later events are dropped
+  ~ProfileRegistry();
+  void report(std::ostream& os);
+  void writeTrace(const char* filename);
+};
+
+ProfileRegistry& registry() { static ProfileRegistry R; return R; }
+
+const std::chrono::steady_clock::time_point clockStart = std::chrono::steady_clock::now();
+
+thread_local ProfileBuffer *threadBuffer=NULL;
+
+ProfileBuffer& buffer() {
+  if(!threadBuffer) {
+    ProfileRegistry& R = registry();
+    std::lock_guard<std::mutex> lock(R.mutex);
+    R.buffers.emplace_back();
+    threadBuffer = &R.buffers.back();
+    threadBuffer->tid = R.buffers.size()-1;
+  }
+  return *threadBuffer;
+}
+
+void add(const char* group, const char* tag, uint64_t n, double sec) {
+  ProfileBuffer& B = buffer();
+  std::lock_guard<std::mutex> lock(B.mutex);
+  static thread_local std::string key; //reused: once its capacity suffices, building the key doesn't allocate
+  if(group) { key.assign(group); key += tag; } else key.assign(tag);
+  auto it = B.entries.find(key);
+  if(it==B.entries.end()) it = B.entries.emplace(key, ProfileEntry()).first;
+  ProfileEntry& e = it->second;
+  e.count += n;
+  if(sec>0.) {
+    e.time += sec;
+    if(sec>e.max) e.max=sec;
+    if(profileState.load(std::memory_order_relaxed)==2) {
+      if(B.events.size()<registry().traceMax) B.events.push_back({it->first, profileClock()-sec, sec});
+      else B.droppedEvents++;
+    }
+  }
+}
+
+void writeQuoted(std::ostream& os, const std::string& s) {
+  os <<'"';
+  for(char c:s) { if(c=='"' || c=='\\') os <<'\\'; os <<c; }
+  os <<'"';
+}
+
+}
+
+int profileInit() {
+  ProfileRegistry& R = registry();
+  std::lock_guard<std::mutex> lock(R.mutex);
+  int s = profileState.load();
+  if(s>=0) return s;
+  R.traceFile = getParameter<String>("profile/trace", String()).p;
+  R.traceMax = getParameter<double>("profile/traceMax", 1e6);
+  s = R.traceFile.size() ? 2 : (getParameter<bool>("profile", false) ? 1 : 0);
+  profileState = s;
+  return s;
+}
+
+void profileEnable(bool on, const char* traceFile) {
+  ProfileRegistry& R = registry();
+  std::lock_guard<std::mutex> lock(R.mutex);
+  R.traceFile = traceFile ? traceFile : "";
+  profileState = !on ? 0 : (R.traceFile.size() ? 2 : 1);
+}
+
+double profileClock() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now()-clockStart).count();
+}
+
+void profileTime(const char* tag, double sec) {
+  if(profileEnabled()) add(NULL, tag, 1, sec);
+}
+
+void profileTime(const char* group, const char* tag, double sec) {
+  if(profileEnabled()) add(group, tag, 1, sec);
+}
+
+void profileCount(const char* tag, uint64_t n) {
+  if(profileEnabled()) add(NULL, tag, n, 0.);
+}
+
+void profileCount(const char* group, const char* tag, uint64_t n) {
+  if(profileEnabled()) add(group, tag, n, 0.);
+}
+
+const char* profileTypeName(const std::type_info& type) {
+  static thread_local std::map<const std::type_info*, std::string> names;
+  std::string& name = names[&type];
+  if(!name.size()) {
+    int status;
+    char *demangled = abi::__cxa_demangle(type.name(), NULL, NULL, &status);
+    name = (status==0 && demangled) ? demangled : type.name();
+    free(demangled);
+  }
+  return name.c_str();
+}
+
+ProfileRegistry::~ProfileRegistry() {
+  if(profileState.load()<=0) return;
+  std::ofstream fil("z.profile");
+  report(fil);
+  if(traceFile.size()) writeTrace(traceFile.c_str());
+}
+
+void ProfileRegistry::report(std::ostream& os) {
+  std::map<std::string, ProfileEntry> all;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for(ProfileBuffer& B:buffers) {
+      std::lock_guard<std::mutex> lockB(B.mutex);
+      for(auto& it:B.entries) {
+        ProfileEntry& e = all[it.first];
+        e.count += it.second.count;
+        e.time += it.second.time;
+        if(it.second.max>e.max) e.max=it.second.max;
+      }
+    }
+  }
+  os <<'[';
+  bool first=true;
+  for(auto& it:all) {
+    os <<(first?"\n":",\n") <<"{ \"tag\": ";
+    writeQuoted(os, it.first);
+    os <<", \"count\": " <<it.second.count <<", \"time\": " <<it.second.time <<", \"max\": " <<it.second.max <<" }";
+    first=false;
+  }
+  os <<"\n]" <<std::endl;
+}
+
+void ProfileRegistry::writeTrace(const char* filename) {
+  std::ofstream fil(filename);
+  fil <<std::fixed <<std::setprecision(3) <<"{\"traceEvents\":[";
+  bool first=true;
+  std::lock_guard<std::mutex> lock(mutex);
+  for(ProfileBuffer& B:buffers) {
+    std::lock_guard<std::mutex> lockB(B.mutex);
+    for(ProfileEvent& e:B.events) {
+      fil <<(first?"\n":",\n") <<"{\"name\":";
+      writeQuoted(fil, e.name);
+      fil <<",\"ph\":\"X\",\"pid\":0,\"tid\":" <<B.tid <<",\"ts\":" <<1e6*e.start <<",\"dur\":" <<1e6*e.dur <<'}';
+      first=false;
+    }
+  }
+  uint64_t dropped=0;
+  for(ProfileBuffer& B:buffers) dropped += B.droppedEvents;
+  fil <<"\n],\"droppedEvents\":" <<dropped <<"}" <<std::endl;
+}
+
+void profileReport(std::ostream& os) { registry().report(os); }
+
+void profileWriteTrace(const char* filename) { registry().writeTrace(filename); }
+
+void profileClear() {
+  ProfileRegistry& R = registry();
+  std::lock_guard<std::mutex> lock(R.mutex);
+  for(ProfileBuffer& B:R.buffers) {
+    std::lock_guard<std::mutex> lockB(B.mutex);
+    B.entries.clear();
+    B.events.clear();
+    B.droppedEvents=0;
+  }
+}
+
+}
@@ -0,0 +1,62 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2017 Marc Toussaint
+    email: marc.toussaint@informatik.uni-stuttgart.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include <atomic>
+#include <iostream>
+#include <stdint.h>
+#include <typeinfo>
+
+//===========================================================================
+//
+// thread-safe hot-path profiling: scoped timers and counters accumulate into
+// per-thread buffers (no locks shared between threads); profileReport merges them.
+// Disabled by default -- then each call costs one relaxed atomic load.
+// Parameters: 'profile' (bool) enables, 'profile/trace' (file name) additionally
+// records every timed scope as Chrome trace event (load in chrome://tracing), at
+// most 'profile/traceMax' events per thread. When enabled, the report is written
+// to 'z.profile' at exit.
+//
+
+namespace rai {
+
+extern std::atomic<int> profileState; ///< -1: uninitialized, 0: off, 1: on, 2: on with trace
+int profileInit();
+inline bool profileEnabled() { int s=profileState.load(std::memory_order_relaxed); if(s<0) s=profileInit(); return s>0; }
+void profileEnable(bool on=true, const char* traceFile=NULL); ///< overrides the parameters
+
+double profileClock(); ///< thread-safe monotonic wall clock in seconds
+
+/// adds a duration to the entry 'tag' (or 'group'+'tag'); tag pointers need not be persistent
+void profileTime(const char* tag, double sec);
+void profileTime(const char* group, const char* tag, double sec);
+/// adds n to the counter of entry 'tag'
+void profileCount(const char* tag, uint64_t n=1);
+void profileCount(const char* group, const char* tag, uint64_t n);
+/// readable (demangled) type name, e.g. as tag for the dynamic type of a feature
+const char* profileTypeName(const std::type_info& type);
+
+/// JSON report of all entries (merged over threads): an array with one line per entry
+/// { "tag": "KOMO/phi", "count": 12, "time": 0.0031, "max": 0.0004 }
+void profileReport(std::ostream& os);
+void profileWriteTrace(const char* filename); ///< Chrome trace event JSON of all recorded scopes
+void profileClear();
+
+/// times its own lifetime into the entry 'tag'
+struct ProfileScope {
+  const char *group, *tag;
+  double start;
+  ProfileScope(const char* tag) : ProfileScope(NULL, tag) {}
+  ProfileScope(const char* _group, const char* _tag) : group(_group), tag(_tag), start(-1.) {
+    if(profileEnabled()) start=profileClock();
+  }
+  ~ProfileScope() { if(start>=0.) profileTime(group, tag, profileClock()-start); }
+};
+
+}
@@ -12,6 +12,7 @@
 #include "util.h"
 #include "array.h"
 #include "graph.h"
+#include <thread>
 
 enum ThreadState { tsIsClosed=-6, tsToOpen=-2, tsLOOPING=-3, tsBEATING=-4, tsIDLE=0, tsToStep=1, tsToClose=-1,  tsFAILURE=-5,  }; //positive states indicate steps-to-go
 struct Signaler;
@@ -450,6 +451,22 @@ struct Signaler {
 
 #endif //RAI_MSVC
 
+//===========================================================================
+
+/// calls f(i) for i=0..n-1, with contiguous chunks of i distributed over threads (threads=0: hardware concurrency)
+template<class F> void parallelFor(uint n, const F& f, uint threads=0) {
+  if(!threads) threads = std::max(1u, std::thread::hardware_concurrency());
+  if(threads>n) threads=n;
+  if(threads<=1) { for(uint i=0; i<n; i++) f(i); return; }
+  std::vector<std::thread> pool;
+  uint chunk = (n+threads-1)/threads;
+  for(uint start=0; start<n; start+=chunk) {
+    uint stop = std::min(n, start+chunk);
+    pool.emplace_back([&f, start, stop]() { for(uint i=start; i<stop; i++) f(i); });
+  }
+  for(std::thread& th:pool) th.join();
+}
+
 template<class T>
 Var<T>::Var()
   : data(make_shared<Var_data<T>>()), thread(0), last_read_revision(0) {}
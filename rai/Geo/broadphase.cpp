@@ -0,0 +1,121 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2017 Marc Toussaint
+    email: marc.toussaint@informatik.uni-stuttgart.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "broadphase.h"
+#include "geo.h"
+
+void rai::SweepAndPrune::init(uint N) {
+  localBox.resize(N, 6).setZero();
+  box.resize(N, 6).setZero();
+  active.resize(N) = false;
+  W = (N+63)/64;
+  filter.resize(N, W).setZero();
+  activeList.resize(N);
+  activePos.resize(N);
+  if(pairs.d0<16) pairs.resize(16, 2);
+  nPairs=0;
+  endpoints.clear();
+  dirty=true;
+}
+
+void rai::SweepAndPrune::setLocalBox(uint i, const arr& lohi) {
+  CHECK_EQ(lohi.N, 6, "need lower and upper corner");
+  for(uint k=0; k<3; k++) {
+    localBox(i, k)   = .5*(lohi.p[k]+lohi.p[3+k]);
+    localBox(i, 3+k) = .5*(lohi.p[3+k]-lohi.p[k]);
+  }
+  if(!active(i)) { active(i)=true; dirty=true; }
+}
+
+void rai::SweepAndPrune::setPose(uint i, const double* X7) {
+  double R[9];
+  rai::Quaternion rot;
+  rot.set(X7+3);
+  rot.getMatrix(R);
+  const double *c = localBox.p+6*i, *h = c+3;
+  double *lo = box.p+6*i, *hi = lo+3;
+  for(uint k=0; k<3; k++) {
+    const double *Rk = R+3*k;
+    double ck = X7[k] + Rk[0]*c[0] + Rk[1]*c[1] + Rk[2]*c[2];
+    double hk = fabs(Rk[0])*h[0] + fabs(Rk[1])*h[1] + fabs(Rk[2])*h[2];
+    lo[k] = ck-hk;
+    hi[k] = ck+hk;
+  }
+}
+
+void rai::SweepAndPrune::setBox(uint i, const double* lo, const double* hi) {
+  memmove(box.p+6*i, lo, 3*sizeof(double));
+  memmove(box.p+6*i+3, hi, 3*sizeof(double));
+  if(!active(i)) { active(i)=true; dirty=true; }
+}
+
+void rai::SweepAndPrune::allowPair(uint i, uint j, bool allow) {
+  uint64_t bi = uint64_t(1)<<(i&63), bj = uint64_t(1)<<(j&63);
+  if(allow) {
+    filter.p[i*W + (j>>6)] |= bj;
+    filter.p[j*W + (i>>6)] |= bi;
+  } else {
+    filter.p[i*W + (j>>6)] &= ~bj;
+    filter.p[j*W + (i>>6)] &= ~bi;
+  }
+}
+
+void rai::SweepAndPrune::rebuildEndpoints() {
+  endpoints.clear();
+  for(uint i=0; i<active.N; i++) if(active(i)) {
+      endpoints.append(2*i);
+      endpoints.append(2*i+1);
+    }
+  dirty=false;
+}
+
+void rai::SweepAndPrune::pushPair(uint i, uint j) {
+  if(nPairs==pairs.d0) pairs.resizeCopy(2*pairs.d0, 2);
+  uint *pair = pairs.p+2*nPairs;
+  if(i<j) { pair[0]=i; pair[1]=j; } else { pair[0]=j; pair[1]=i; }
+  nPairs++;
+}
+
+uint rai::SweepAndPrune::step() {
+  if(dirty) rebuildEndpoints();
+
+  //-- insertion sort: boxes move little between steps, so this is near-linear
+  uint *e = endpoints.p;
+  for(uint k=1; k<endpoints.N; k++) {
+    uint code = e[k];
+    double v = endpointValue(code);
+    uint j=k;
+    for(; j>0 && endpointValue(e[j-1])>v; j--) e[j]=e[j-1];
+    e[j]=code;
+  }
+
+  //-- sweep along x, test y & z overlap and the filter only for the x-overlapping candidates
+  nPairs=0;
+  uint nActive=0;
+  for(uint k=0; k<endpoints.N; k++) {
+    uint i = e[k]>>1;
+    if(!(e[k]&1)) { //lower end: test against all currently open boxes, then open
+      const double *bi = box.p+6*i;
+      for(uint a=0; a<nActive; a++) {
+        uint j = activeList.p[a];
+        if(!isAllowed(i, j)) continue;
+        const double *bj = box.p+6*j;
+        if(bi[1]>bj[4] || bj[1]>bi[4] || bi[2]>bj[5] || bj[2]>bi[5]) continue;
+        pushPair(i, j);
+      }
+      activePos.p[i] = nActive;
+      activeList.p[nActive++] = i;
+    } else { //upper end: close
+      uint last = activeList.p[--nActive];
+      activeList.p[activePos.p[i]] = last;
+      activePos.p[last] = activePos.p[i];
+    }
+  }
+  CHECK_EQ(nActive, 0, "unbalanced endpoints");
+  return nPairs;
+}
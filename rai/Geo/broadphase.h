@@ -0,0 +1,55 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2017 Marc Toussaint
+    email: marc.toussaint@informatik.uni-stuttgart.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include <Core/array.h>
+
+namespace rai {
+
+/// incremental sweep-and-prune broadphase over axis-aligned boxes
+/// - world AABBs persist between steps: only objects updated with setPose/setBox are touched
+/// - the endpoint list along x is kept sorted by insertion sort (near-linear for coherent motion)
+/// - a pair-filter bitset decides which pairs are reported at all (precompute once, e.g. from canCollideWith)
+/// - results are written into the preallocated buffer 'pairs' (first nPairs rows are valid)
+struct SweepAndPrune {
+  arr localBox;       ///< N x 6: center (3) and half extents (3) of each object in its own frame
+  arr box;            ///< N x 6: world lower (3) and upper (3) corner of each object
+  boolA active;       ///< only active objects (those with a localBox) take part
+  Array<uint64_t> filter; ///< N x W bitset: bit j of row i is set if the pair (i,j) may be reported
+  uintA pairs;        ///< pair buffer (capacity x 2), grows by doubling, never shrinks
+  uint nPairs=0;      ///< number of valid rows in 'pairs' after the last step
+
+  SweepAndPrune(uint N=0) { init(N); }
+
+  void init(uint N);
+  uint size() const { return active.N; }
+
+  //-- geometry
+  void setLocalBox(uint i, const arr& lohi); ///< 2 x 3 local [lower; upper] corners (e.g. Mesh::getBox)
+  void setPose(uint i, const double* X7);    ///< update world box from pose (x,y,z, qw,qx,qy,qz)
+  void setBox(uint i, const double* lo, const double* hi);
+
+  //-- filter
+  void allowPair(uint i, uint j, bool allow=true);
+  bool isAllowed(uint i, uint j) const { return filter.p[i*W + (j>>6)] & (uint64_t(1)<<(j&63)); }
+
+  uint step(); ///< sort, sweep, fill 'pairs'; returns nPairs
+
+private:
+  uint W=0;            ///< words per filter row
+  uintA endpoints;     ///< sorted endpoint codes along x: 2*i for the lower, 2*i+1 for the upper end of object i
+  uintA activeList, activePos; ///< objects currently overlapping the sweep position, and their index in activeList
+  bool dirty=true;     ///< the endpoint list needs rebuilding (after init/activation)
+
+  double endpointValue(uint code) const { return box.p[6*(code>>1) + 3*(code&1)]; }
+  void rebuildEndpoints();
+  void pushPair(uint i, uint j);
+};
+
+} //namespace rai
@@ -10,8 +10,9 @@
 
 bool FclInterfaceBroadphaseCallback(fcl::CollisionObject* o1, fcl::CollisionObject* o2, void* cdata_);
 
-rai::FclInterface::FclInterface(const rai::Array<ptr<Mesh> >& _geometries, double _cutoff)
-  : geometries(_geometries), cutoff(_cutoff){
+rai::FclInterface::FclInterface(const rai::Array<ptr<Mesh> >& _geometries, double _cutoff, bool useManager)
+  : geometries(_geometries), broadphase(geometries.N), cutoff(_cutoff){
+  objects.resize(geometries.N, NULL);
   for(long int i=0;i<geometries.N;i++){
     if(geometries(i)){
       rai::Mesh& mesh = *geometries(i);
@@ -23,13 +24,21 @@ rai::FclInterface::FclInterface(const rai::Array<ptr<Mesh> >& _geometries, doubl
       model->setUserData((void*)(i));
       fcl::CollisionObject* obj = new fcl::CollisionObject(std::shared_ptr<fcl::CollisionGeometry>(model), fcl::Transform3f());
       obj->setUserData((void*)(i));
-      objects.push_back(obj);
+      objects[i] = obj;
+      broadphase.setLocalBox(i, mesh.getBox());
+      for(uint j=0;j<i;j++) if(geometries(j)) broadphase.allowPair(i, j);
     }
   }
+  X.resize(geometries.N, 7).setZero();
+  for(uint i=0;i<X.d0;i++) X(i,3) = 2.; //an invalid quaternion: forces the update on the first setPose
 
-  manager = new fcl::DynamicAABBTreeCollisionManager();
-  manager->registerObjects(objects);
-  manager->setup();
+  if(useManager){
+    std::vector<fcl::CollisionObject*> objs;
+    for(auto *obj:objects) if(obj) objs.push_back(obj);
+    manager = new fcl::DynamicAABBTreeCollisionManager();
+    manager->registerObjects(objs);
+    manager->setup();
+  }
 }
 
 rai::FclInterface::~FclInterface(){
@@ -38,50 +47,91 @@ rai::FclInterface::~FclInterface(){
   delete manager;
 }
 
-void rai::FclInterface::step(const arr& X){
-  CHECK_EQ(X.nd, 2, "");
-  CHECK_EQ(X.d0, geometries.size(), "");
-  CHECK_EQ(X.d1, 7, "");
+void rai::FclInterface::setPose(uint i, const double* X7){
+  double *x = X.p+7*i;
+  if(!memcmp(x, X7, 7*sizeof(double))) return;
+  memmove(x, X7, 7*sizeof(double));
+  if(!objects[i]) return;
+  objects[i]->setTranslation(fcl::Vec3f(x[0], x[1], x[2]));
+  objects[i]->setQuatRotation(fcl::Quaternion3f(x[3], x[4], x[5], x[6]));
+  broadphase.setPose(i, x);
+}
+
+void rai::FclInterface::step(const arr& _X){
+  CHECK_EQ(_X.nd, 2, "");
+  CHECK_EQ(_X.d0, geometries.size(), "");
+  CHECK_EQ(_X.d1, 7, "");
 
-  for(auto *obj:objects){
-    uint i = (long int)obj->getUserData();
-    obj->setTranslation(fcl::Vec3f(X(i,0), X(i,1), X(i,2)));
-    obj->setQuatRotation(fcl::Quaternion3f(X(i,3), X(i,4), X(i,5), X(i,6)));
-    obj->computeAABB();
+  for(uint i=0;i<_X.d0;i++) setPose(i, _X.p+7*i);
+  step();
+}
+
+void rai::FclInterface::step(){
+  if(manager){ //all AABBs are recomputed, the pair filter is applied per reported pair
+    for(auto *obj:objects) if(obj) obj->computeAABB();
+    manager->update();
+    collisions.clear();
+    manager->collide(this, FclInterfaceBroadphaseCallback);
+    collisions.reshape(collisions.N/2, 2);
+    return;
   }
-  manager->update();
 
-  collisions.clear();
-  manager->collide(this, FclInterfaceBroadphaseCallback);
-  collisions.reshape(collisions.N/2,2);
+  uint n = broadphase.step();
+  collisions.resize(n, 2);
+
+  uint k=0;
+  for(uint p=0;p<n;p++){
+    uint i = broadphase.pairs.p[2*p], j = broadphase.pairs.p[2*p+1];
+    fcl::CollisionObject *o1 = objects[i], *o2 = objects[j];
+    bool hit;
+    if(cutoff==0.){
+      fcl::CollisionRequest request;
+      fcl::CollisionResult result;
+      fcl::collide(o1, o2, request, result);
+      hit = result.isCollision();
+    }else if(cutoff>0.){
+      fcl::DistanceRequest request;
+      fcl::DistanceResult result;
+      hit = fcl::distance(o1, o2, request, result) < cutoff;
+    }else{
+      hit = true;
+    }
+    if(hit){
+      collisions.p[2*k] = i;
+      collisions.p[2*k+1] = j;
+      k++;
+    }
+  }
+  collisions.resizeCopy(k, 2);
 }
 
 bool FclInterfaceBroadphaseCallback(fcl::CollisionObject* o1, fcl::CollisionObject* o2, void* cdata_){
   rai::FclInterface* self = static_cast<rai::FclInterface*>(cdata_);
+  uint i = (long int)o1->getUserData(), j = (long int)o2->getUserData();
+  if(i<j) std::swap(i, j);
+  if(!self->broadphase.isAllowed(i, j)) return false;
 
+  bool hit;
   if(self->cutoff==0.){
     fcl::CollisionRequest request;
     fcl::CollisionResult result;
     fcl::collide(o1, o2, request, result);
-    if(result.isCollision()){
-      self->collisions.append(TUP( (long int)o1->getUserData(), (long int)o2->getUserData() ));
-    }
+    hit = result.isCollision();
   }else if(self->cutoff>0.){
     fcl::DistanceRequest request;
     fcl::DistanceResult result;
-    double d = fcl::distance(o1, o2, request, result);
-    if(d<self->cutoff){
-      self->collisions.append(TUP( (long int)o1->getUserData(), (long int)o2->getUserData() ));
-    }
+    hit = fcl::distance(o1, o2, request, result) < self->cutoff;
   }else{
-    self->collisions.append(TUP( (long int)o1->getUserData(), (long int)o2->getUserData() ));
+    hit = true;
   }
+  if(hit) self->collisions.append(TUP(i, j));
   return false;
 }
 
-
 #else //RAI_FCL
-rai::FclInterface::FclInterface(const Array<ptr<Mesh> >& _geometries, double _cutoff){ NICO }
+rai::FclInterface::FclInterface(const Array<ptr<Mesh> >& _geometries, double _cutoff, bool useManager){ NICO }
 rai::FclInterface::~FclInterface(){ NICO }
-  void rai::FclInterface::step(const arr& X){ NICO }
+void rai::FclInterface::setPose(uint i, const double* X7){ NICO }
+void rai::FclInterface::step(){ NICO }
+void rai::FclInterface::step(const arr& X){ NICO }
 #endif
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "mesh.h"
+#include "broadphase.h"
 
 namespace fcl{
   class CollisionObject;
@@ -11,17 +12,20 @@ namespace rai{
 
 struct FclInterface{
   Array<ptr<Mesh>> geometries;
-  std::vector<fcl::CollisionObject*> objects;
-  fcl::DynamicAABBTreeCollisionManager* manager;
+  std::vector<fcl::CollisionObject*> objects; ///< indexed like geometries (NULL where there is no geometry)
+  SweepAndPrune broadphase;                   ///< persistent AABBs and pair filter (initially: all pairs of geometries allowed)
+  arr X;                                      ///< poses (N x 7) of the last step; only changed rows are updated
+  fcl::DynamicAABBTreeCollisionManager* manager=NULL; ///< fcl's own broadphase instead (the former path, kept for comparison)
 
   double cutoff=0.;
-  uintA collisions;
+  uintA collisions; ///< (n x 2) colliding pairs; the buffer is reused between steps
 
-  FclInterface(const Array<ptr<Mesh>>& _geometries, double _cutoff=0.);
+  FclInterface(const Array<ptr<Mesh>>& _geometries, double _cutoff=0., bool useManager=false);
   ~FclInterface();
 
+  void setPose(uint i, const double* X7); ///< (x,y,z, qw,qx,qy,qz); no-op if unchanged since the last step
+  void step(); ///< collide with the poses set so far
   void step(const arr& X);
 };
 
 }
-
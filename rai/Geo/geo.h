@@ -390,6 +390,8 @@ std::ostream& operator<<(std::ostream&, const Transformation&);
 inline arr conv_vec2arr(const rai::Vector& v) {      return arr(&v.x, 3, false); }
 inline arr conv_quat2arr(const rai::Quaternion& q) { return arr(&q.w, 4, false); }
 inline arr conv_mat2arr(const rai::Matrix& m) {      return arr(&m.m00, 9, false).reshape(3,3); }
+inline void conv_vec2arr(arr& y, const rai::Vector& v) {      y.resize(3); y.p[0]=v.x; y.p[1]=v.y; y.p[2]=v.z; } ///< without temporary
+inline void conv_quat2arr(arr& y, const rai::Quaternion& q) { y.resize(4); y.p[0]=q.w; y.p[1]=q.x; y.p[2]=q.y; y.p[3]=q.z; } ///< without temporary
 
 //===========================================================================
 //
@@ -9,8 +9,16 @@
 #include "mesh.h"
 #include "qhull.h"
 #include "mesh_readAssimp.h"
+#include <Core/thread.h>
+#include <unordered_map>
+#include <thread>
 
 #include <limits>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #define RAI_extern_ply
 #define RAI_extern_GJK
@@ -366,7 +374,13 @@ void rai::Mesh::addMesh(const Mesh& mesh2, const rai::Transformation& X) {
 void rai::Mesh::makeConvexHull() {
   if(!V.N) return;
 #if 1
-  V = getHull(V, T);
+  if(!readCachedHull()) {
+    Mesh hull;
+    hull.V = getHull(V, hull.T);
+    writeCachedHull(hull);
+    V = hull.V;
+    T = hull.T;
+  }
   if(C.nd==2) C = mean(C);
   Vn.clear();
   Tn.clear();
@@ -441,27 +455,33 @@ void rai::Mesh::setSSCvx(const rai::Mesh& m, double r, uint fineness) {
   all adjacent triangles that are in the triangle list or member of
   a strip */
 void rai::Mesh::computeNormals() {
-  uint i;
-  Vector a, b, c;
   Tn.resize(T.d0, 3);
-  Tn.setZero();
   Vn.resize(V.d0, 3);
-  Vn.setZero();
-  //triangle normals and contributions
-  for(i=0; i<T.d0; i++) {
+  uint threads = (T.d0>=20000 ? 0 : 1); //threading only pays off for large meshes
+  //triangle normals
+  parallelFor(T.d0, [this](uint i) {
+    Vector a, b, c;
     uint *t=T.p+3*i;
     a.set(V.p+3*t[0]);
     b.set(V.p+3*t[1]);
     c.set(V.p+3*t[2]);
-    
     b-=a; c-=a; a=b^c; if(!a.isZero) a.normalize();
     Tn(i, 0)=a.x;  Tn(i, 1)=a.y;  Tn(i, 2)=a.z;
-    Vn(t[0], 0)+=a.x;  Vn(t[0], 1)+=a.y;  Vn(t[0], 2)+=a.z;
-    Vn(t[1], 0)+=a.x;  Vn(t[1], 1)+=a.y;  Vn(t[1], 2)+=a.z;
-    Vn(t[2], 0)+=a.x;  Vn(t[2], 1)+=a.y;  Vn(t[2], 2)+=a.z;
-  }
-  Vector d;
-  for(i=0; i<Vn.d0; i++) { d.set(&Vn(i, 0)); Vn[i]()/=d.length(); }
+  }, threads);
+  //vertex normals: sum over the adjacent triangles (in triangle order, as sequential accumulation would)
+  uintA start(V.d0+1), adj(T.N);
+  start.setZero();
+  for(uint k=0; k<T.N; k++) start(T.p[k]+1)++;
+  for(uint i=0; i<V.d0; i++) start(i+1) += start(i);
+  uintA fill = start;
+  for(uint k=0; k<T.N; k++) adj(fill(T.p[k])++) = k/3;
+  parallelFor(V.d0, [this, &start, &adj](uint i) {
+    double *n = Vn.p+3*i;
+    n[0]=n[1]=n[2]=0.;
+    for(uint k=start(i); k<start(i+1); k++) { double *tn=Tn.p+3*adj(k); n[0]+=tn[0]; n[1]+=tn[1]; n[2]+=tn[2]; }
+    double l = ::sqrt(n[0]*n[0]+n[1]*n[1]+n[2]*n[2]);
+    n[0]/=l; n[1]/=l; n[2]/=l;
+  }, threads);
 }
 
 /** @brief add triangles according to the given grid; grid has to be a 2D
@@ -598,56 +618,47 @@ void rai::Mesh::deleteUnusedVertices() {
   V.resizeCopy(Nused, 3);
 }
 
-arr *COMP_V;
-bool COMP(uint i, uint j) {
-  bool r=(*COMP_V)[i]<(*COMP_V)[j];
-  return r;
-}
-
 /** @brief delete all void triangles (with vertex indices (0, 0, 0)) and void
   vertices (not used for triangles or strips) */
 void rai::Mesh::fuseNearVertices(double tol) {
+  CHECK(tol>0., "the tolerance is also the grid cell size");
   if(!V.N) return;
-  uintA p;
-  uint i, j;
   
   if(C.N==V.N) C.clear();
 
-//  cout <<"fusing vertices: #V=" <<V.d0 <<", sorting.." <<std::flush;
-  //cout <<V <<endl;
-  //sort vertices lexically
-  p.setStraightPerm(V.d0);
-  COMP_V=&V;
-  uint *pstop=p.p+p.N;
-  std::sort(p.p, pstop, COMP);
-  permuteVertices(*this, p);
-  
-//  cout <<"permuting.." <<std::flush;
-  //cout <<V <<endl;
-  p.setStraightPerm(V.d0);
-  for(i=0; i<V.d0; i++) {
-    if(p(i)!=i) continue;  //i has already been fused with p(i), and p(i) has already been checked...
-    for(j=i+1; j<V.d0; j++) {
-      if(V(j, 0)-V(i, 0)>tol) break;
-      if(rai::sqr(V(j, 0)-V(i, 0))+rai::sqr(V(j, 1)-V(i, 1))+rai::sqr(V(j, 2)-V(i, 2))<tol*tol) {
-        //cout <<"fusing " <<i <<" " <<j <<" " <<V[i] <<" " <<V[j] <<endl;
-        p(j)=i;
+  //spatial hashing on a grid of cell size tol: each vertex is fused with the first earlier
+  //(unfused) vertex within tol, which can only be in the same or one of the 26 neighboring cells
+  auto cellKey = [](int64_t x, int64_t y, int64_t z) -> uint64_t {
+    return ((uint64_t)(x&0x1fffff)<<42) | ((uint64_t)(y&0x1fffff)<<21) | (uint64_t)(z&0x1fffff);
+  };
+  std::unordered_map<uint64_t, uint> cells; //cell -> first representative in that cell
+  intA next(V.d0); //list of further representatives in the same cell
+  uintA p(V.d0);
+  double tol2=tol*tol;
+  for(uint i=0; i<V.d0; i++) {
+    const double *v=V.p+3*i;
+    int64_t cx=::floor(v[0]/tol), cy=::floor(v[1]/tol), cz=::floor(v[2]/tol);
+    p(i)=i;
+    for(int64_t dx=-1; dx<=1 && p(i)==i; dx++) for(int64_t dy=-1; dy<=1 && p(i)==i; dy++) for(int64_t dz=-1; dz<=1 && p(i)==i; dz++) {
+      auto it = cells.find(cellKey(cx+dx, cy+dy, cz+dz));
+      if(it==cells.end()) continue;
+      for(int j=it->second; j>=0; j=next(j)) {
+        const double *w=V.p+3*j;
+        if(rai::sqr(v[0]-w[0])+rai::sqr(v[1]-w[1])+rai::sqr(v[2]-w[2])<tol2) { p(i)=j; break; }
       }
     }
+    if(p(i)==i) { //new representative
+      auto ins = cells.emplace(cellKey(cx, cy, cz), i);
+      next(i) = -1;
+      if(!ins.second) { next(i) = next(ins.first->second); next(ins.first->second) = i; }
+    }
   }
   
-  uintA y(T.d0, 3);
-  for(i=0; i<T.d0; i++) { y(i, 0)=p(T(i, 0)); y(i, 1)=p(T(i, 1)); y(i, 2)=p(T(i, 2)); }
-  T=y;
+  for(uint k=0; k<T.N; k++) T.p[k] = p(T.p[k]);
   
-//  cout <<"deleting tris.." <<std::flush;
   deleteZeroTriangles(*this);
-  
-//  cout <<"deleting verts.." <<std::flush;
   deleteUnusedVertices();
   
-//  cout <<"#V=" <<V.d0 <<", done" <<endl;
-  
   Tt.clear();
   tex.clear();
   texImg.clear();
@@ -1045,11 +1056,22 @@ void rai::Mesh::write(std::ostream& os) const {
 void rai::Mesh::readFile(const char* filename) {
   const char* fileExtension = filename+(strlen(filename)-3);
 //  if(!strcmp(fileExtension, "obj")) { *this = mesh_readAssimp(filename); } else
-  if(!strcmp(fileExtension, "dae") || !strcmp(fileExtension, "DAE")) { *this = AssimpLoader(filename).getSingleMesh(); }
+  if(!strcmp(fileExtension, "dae") || !strcmp(fileExtension, "DAE")) {
+    if(readCached(filename)) return;
+    *this = AssimpLoader(filename).getSingleMesh();
+    writeCached(filename);
+  }
   else read(FILE(filename).getIs(), fileExtension, filename);
 }
 
 void rai::Mesh::read(std::istream& is, const char* fileExtension, const char* filename) {
+  if(!strcmp(fileExtension, "rmb")) {
+    if(!readBinary(filename)) HALT("could not read binary mesh file '" <<filename <<"'");
+    return;
+  }
+  arr presetC = C; //a color set before loading (e.g. by the shape) is not part of the file, nor of its cache entry
+  C.clear();
+  if(filename && readCached(filename)) { if(!C.N) C=presetC; return; }
   bool loaded=false;
   if(!strcmp(fileExtension, "obj")) { readObjFile(is); loaded=true; }
   if(!strcmp(fileExtension, "off")) { readOffFile(is); loaded=true; }
@@ -1059,6 +1081,255 @@ void rai::Mesh::read(std::istream& is, const char* fileExtension, const char* fi
   if(!strcmp(fileExtension, "stl") || !strcmp(fileExtension, "STL")) { loaded = readStlFile(is); }
   if(!strcmp(fileExtension, "dae") || !strcmp(fileExtension, "DAE")) { *this = AssimpLoader(filename).getSingleMesh(); loaded=true; }
   if(!loaded) HALT("can't read fileExtension '" <<fileExtension <<"' file '" <<filename <<"'");
+  if(filename) writeCached(filename);
+  if(!C.N) C=presetC;
+}
+
+//==============================================================================
+//
+// binary mesh files and cache
+//
+
+namespace {
+
+const char rmbMagic[8] = {'R','A','I','M','E','S','H','1'};
+
+/// file header; the source stamp is only used by the cache
+struct RmbHeader {
+  char magic[8];
+  uint32_t numSections;
+  uint32_t hasHull;
+  int64_t srcMtime;
+  uint64_t srcSize;
+  uint64_t srcHash;
+};
+
+/// each section: one array, its data padded to 8 bytes
+struct RmbSection {
+  char tag[4];
+  uint32_t elemSize;
+  uint32_t nd;
+  uint32_t d[3];
+  uint64_t N;
+};
+
+uint64_t fnv1a(const char* p, size_t n, uint64_t h=14695981039346656037ull) {
+  for(size_t i=0; i<n; i++) { h ^= (unsigned char)p[i]; h *= 1099511628211ull; }
+  return h;
+}
+
+template<class T> void writeSection(std::ostream& os, const char* tag, const rai::Array<T>& x) {
+  CHECK_LE(x.nd, 3, "");
+  RmbSection sec;
+  memcpy(sec.tag, tag, 4);
+  sec.elemSize = sizeof(T);
+  sec.nd = x.nd;
+  sec.d[0]=x.d0;  sec.d[1]=x.d1;  sec.d[2]=x.d2;
+  sec.N = x.N;
+  os.write((char*)&sec, sizeof(sec));
+  os.write((char*)x.p, x.N*sizeof(T));
+  char zeros[8] = {0};
+  os.write(zeros, (8-(x.N*sizeof(T))%8)%8);
+}
+
+/// checks the section at p; returns the number of bytes it takes, 0 if it is invalid or truncated
+size_t checkSection(const char* p, size_t left, const char* tag, uint32_t elemSize) {
+  if(left<sizeof(RmbSection)) return 0;
+  const RmbSection& sec = *(const RmbSection*)p;
+  if(memcmp(sec.tag, tag, 4) || sec.elemSize!=elemSize || sec.nd>3) return 0;
+  if(sec.N!=(sec.nd==0 ? 0 : sec.nd==1 ? sec.d[0] : sec.nd==2 ? uint64_t(sec.d[0])*sec.d[1] : uint64_t(sec.d[0])*sec.d[1]*sec.d[2])) return 0;
+  size_t bytes = sec.N*elemSize;
+  size_t total = sizeof(RmbSection) + bytes + (8-bytes%8)%8;
+  if(left<total) return 0;
+  return total;
+}
+
+/// lets the (cleared) x live in the checked section at p, which is then advanced to the next section
+template<class T> void mapSection(rai::Array<T>& x, char*& p) {
+  const RmbSection& sec = *(const RmbSection*)p;
+  size_t bytes = sec.N*sizeof(T);
+  x.setLocalMEM((T*)(p+sizeof(RmbSection)), sec.N, sec.N);
+  if(sec.nd==2) x.reshape(sec.d[0], sec.d[1]);
+  if(sec.nd==3) x.reshape(sec.d[0], sec.d[1], sec.d[2]);
+  p += sizeof(RmbSection) + bytes + (8-bytes%8)%8;
+}
+
+/// clears m and lets it drop the memory of a previous mapping
+void unmapMesh(rai::Mesh& m) {
+  m.clear();  m.Tt.clear();  m.tex.clear();  m.texImg.clear();
+  m.V.setLocalMEM(NULL, 0);  m.T.setLocalMEM(NULL, 0);  m.Vn.setLocalMEM(NULL, 0);  m.Tn.setLocalMEM(NULL, 0);  m.C.setLocalMEM(NULL, 0);
+  m.Tt.setLocalMEM(NULL, 0);  m.tex.setLocalMEM(NULL, 0);  m.texImg.setLocalMEM(NULL, 0);
+  m.mapping.file.reset();
+}
+
+bool getSourceStamp(const char* filename, int64_t& mtime, uint64_t& size) {
+  struct stat st;
+  if(stat(filename, &st)) return false;
+  mtime = (int64_t)st.st_mtim.tv_sec*1000000000ll + st.st_mtim.tv_nsec;
+  size = st.st_size;
+  return true;
+}
+
+uint64_t getSourceHash(const char* filename) {
+  rai::MappedFile src(filename);
+  return fnv1a(src.p, src.n);
+}
+
+/// Mesh/cacheDir (created on first use), or empty if there is no cache
+const rai::String& getCacheDir() {
+  static rai::String cacheDir = rai::getParameter<rai::String>("Mesh/cacheDir", "");
+  static bool created = cacheDir.N && (!mkdir(cacheDir, 0755) || errno==EEXIST);
+  static rai::String none;
+  return created ? cacheDir : none;
+}
+
+/// the cache file of a source: named by the hash of its absolute path
+rai::String getCacheFile(const char* filename) {
+  if(!getCacheDir().N) return rai::String();
+  char *path = realpath(filename, NULL);
+  if(!path) return rai::String();
+  rai::String file;
+  file <<getCacheDir() <<'/' <<std::hex <<fnv1a(path, strlen(path)) <<".rmb";
+  free(path);
+  return file;
+}
+
+/// the cache file of the convex hull of the vertices V: named by the hash of their bytes (the file also stores V to compare)
+rai::String getHullCacheFile(const arr& V) {
+  if(!getCacheDir().N) return rai::String();
+  rai::String file;
+  file <<getCacheDir() <<"/hull-" <<std::hex <<fnv1a((const char*)V.p, V.N*sizeof(double)) <<".rmb";
+  return file;
+}
+
+bool writeRmb(const char* filename, const rai::Mesh& M, const rai::Mesh* hull, const RmbHeader& head) {
+  std::ofstream os(filename, std::ios::binary);
+  if(!os.good()) return false;
+  os.write((char*)&head, sizeof(head));
+  writeSection(os, "V   ", M.V);
+  writeSection(os, "T   ", M.T);
+  writeSection(os, "Vn  ", M.Vn);
+  writeSection(os, "Tn  ", M.Tn);
+  writeSection(os, "C   ", M.C);
+  if(hull) {
+    writeSection(os, "HV  ", hull->V);
+    writeSection(os, "HT  ", hull->T);
+  }
+  return os.good();
+}
+
+/// writes to a temporary file, then renames: readers never see partial files, and meshes mapping the old file keep it
+bool replaceRmb(const char* filename, const rai::Mesh& M, const rai::Mesh* hull, const RmbHeader& head) {
+  rai::String tmp;
+  tmp <<filename <<'.' <<getpid() <<'.' <<std::hash<std::thread::id>()(std::this_thread::get_id());
+  if(!writeRmb(tmp, M, hull, head) || rename(tmp, filename)) { unlink(tmp); return false; }
+  return true;
+}
+
+RmbHeader rmbHeader(bool hasHull) {
+  RmbHeader head;
+  memset(&head, 0, sizeof(head));
+  memcpy(head.magic, rmbMagic, 8);
+  head.numSections = hasHull ? 7 : 5;
+  head.hasHull = hasHull ? 1 : 0;
+  return head;
+}
+
+} //namespace
+
+rai::MappedFile::MappedFile(const char* filename) {
+  int fd = ::open(filename, O_RDONLY);
+  if(fd<0) return;
+  struct stat st;
+  if(!fstat(fd, &st) && st.st_size>0) {
+    void *m = mmap(NULL, st.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if(m!=MAP_FAILED) { p=(char*)m; n=st.st_size; }
+  }
+  close(fd);
+}
+
+rai::MappedFile::~MappedFile() { if(p) munmap(p, n); }
+
+void rai::Mesh::writeBinary(const char* filename, const Mesh* cvxHull) const {
+  CHECK(replaceRmb(filename, *this, cvxHull, rmbHeader(cvxHull)), "could not write '" <<filename <<"'");
+}
+
+bool rai::Mesh::readBinary(const char* filename, Mesh* cvxHull) {
+  std::shared_ptr<MappedFile> file = make_shared<MappedFile>(filename);
+  if(!file->p || file->n<sizeof(RmbHeader)) return false;
+  const RmbHeader& head = *(const RmbHeader*)file->p;
+  if(memcmp(head.magic, rmbMagic, 8)) return false;
+  if(cvxHull && !head.hasHull) return false;
+  //check all sections first: a failure leaves the meshes untouched
+  const char *tags[7] = {"V   ", "T   ", "Vn  ", "Tn  ", "C   ", "HV  ", "HT  "};
+  const uint32_t elemSizes[7] = {sizeof(double), sizeof(uint), sizeof(double), sizeof(double), sizeof(double), sizeof(double), sizeof(uint)};
+  char *p = file->p+sizeof(RmbHeader);
+  size_t left = file->n-sizeof(RmbHeader), k;
+  for(uint i=0; i<(cvxHull?7u:5u); i++) {
+    if(!(k=checkSection(p, left, tags[i], elemSizes[i]))) return false;
+    p+=k; left-=k;
+  }
+  //the arrays live in the mapping (copy-on-write); they are copied to the heap only when they grow
+  p = file->p+sizeof(RmbHeader);
+  unmapMesh(*this);
+  mapSection(V, p);  mapSection(T, p);  mapSection(Vn, p);  mapSection(Tn, p);  mapSection(C, p);
+  mapping.file = file;
+  if(cvxHull) {
+    unmapMesh(*cvxHull);
+    mapSection(cvxHull->V, p);  mapSection(cvxHull->T, p);
+    cvxHull->mapping.file = file;
+  }
+  return true;
+}
+
+bool rai::Mesh::readCached(const char* filename) {
+  rai::String cacheFile = getCacheFile(filename);
+  if(!cacheFile.N) return false;
+  int64_t mtime;
+  uint64_t size;
+  if(!getSourceStamp(filename, mtime, size)) return false;
+
+  RmbHeader head;
+  {
+    std::ifstream is(cacheFile, std::ios::binary);
+    if(!is.read((char*)&head, sizeof(head)) || memcmp(head.magic, rmbMagic, 8)) return false;
+  }
+  if(head.srcSize!=size) return false;
+  if(head.srcMtime==mtime) return readBinary(cacheFile);
+  //touched or copied: compare the content hash instead, and restamp the entry
+  if(head.srcHash!=getSourceHash(filename)) return false;
+  if(!readBinary(cacheFile)) return false;
+  head.srcMtime = mtime;
+  if(!replaceRmb(cacheFile, *this, NULL, head)) LOG(-1) <<"could not write mesh cache file '" <<cacheFile <<"'";
+  return true;
+}
+
+void rai::Mesh::writeCached(const char* filename) const {
+  rai::String cacheFile = getCacheFile(filename);
+  if(!cacheFile.N) return;
+  RmbHeader head = rmbHeader(false);
+  if(!getSourceStamp(filename, head.srcMtime, head.srcSize)) return;
+  head.srcHash = getSourceHash(filename);
+  if(!replaceRmb(cacheFile, *this, NULL, head)) LOG(-1) <<"could not write mesh cache file '" <<cacheFile <<"'";
+}
+
+bool rai::Mesh::readCachedHull() {
+  rai::String cacheFile = getHullCacheFile(V);
+  if(!cacheFile.N) return false;
+  Mesh key, hull;
+  if(!key.readBinary(cacheFile, &hull) || key.V!=V) return false;
+  V = hull.V;
+  T = hull.T;
+  return true;
+}
+
+void rai::Mesh::writeCachedHull(const Mesh& hull) const {
+  rai::String cacheFile = getHullCacheFile(V);
+  if(!cacheFile.N) return;
+  Mesh key; //only the vertices, to compare with on reading
+  key.V.referTo(V.p, V.N);
+  key.V.reshapeAs(V);
+  if(!replaceRmb(cacheFile, key, &hull, rmbHeader(true))) LOG(-1) <<"could not write hull cache file '" <<cacheFile <<"'";
 }
 
 void rai::Mesh::writeTriFile(const char* filename) {
@@ -23,6 +23,15 @@ void glDrawMeshes(void*, OpenGL&);
 
 namespace rai {
 
+//===========================================================================
+/// a private (copy-on-write) read-write mapping of a whole file; arrays can live in it, see Array::setLocalMEM
+struct MappedFile {
+  char *p=NULL;
+  size_t n=0;
+  MappedFile(const char* filename);
+  ~MappedFile();
+};
+
 //===========================================================================
 /// a mesh (arrays of vertices, triangles, colors & normals)
 struct Mesh : GLDrawer {
@@ -42,6 +51,14 @@ struct Mesh : GLDrawer {
   
   rai::Transformation glX; ///< transform (only used for drawing! Otherwise use applyOnPoints)  (optional)
   
+  /// keeps the file alive that the arrays live in after readBinary (until they grow); not passed on, copies of a mesh copy its arrays
+  struct Mapping {
+    std::shared_ptr<MappedFile> file;
+    Mapping() {}
+    Mapping(const Mapping&) {}
+    Mapping& operator=(const Mapping&) { return *this; }
+  } mapping;
+  
   long parsing_pos_start;
   long parsing_pos_end;
   
@@ -77,7 +94,7 @@ struct Mesh : GLDrawer {
   Vector center();
   void box();
   void addMesh(const rai::Mesh& mesh2, const rai::Transformation& X=0);
-  void makeConvexHull();
+  void makeConvexHull(); ///< reuses (or stores) the hull in Mesh/cacheDir, keyed by the vertices
   void makeTriangleFan();
   void makeLineStrip();
   
@@ -123,6 +140,12 @@ struct Mesh : GLDrawer {
   void readPLY(const char *fn);
   void writeArr(std::ostream&);
   void readArr(std::istream&);
+  void writeBinary(const char* filename, const Mesh* cvxHull=NULL) const; ///< compact binary format (.rmb): V, T, normals, colors, and optionally a convex hull
+  bool readBinary(const char* filename, Mesh* cvxHull=NULL);              ///< maps a .rmb file, the arrays live in the mapping; false if invalid (or the hull is requested but missing)
+  bool readCached(const char* filename);                                  ///< load from the binary cache in Mesh/cacheDir, if up-to-date with the source file
+  void writeCached(const char* filename) const;                           ///< store in the binary cache (atomically, safe for concurrent processes)
+  bool readCachedHull();                                                  ///< replace V, T by the cached convex hull of V, if there is one
+  void writeCachedHull(const Mesh& hull) const;                           ///< store the convex hull of V in the binary cache
   
   void glDraw(struct OpenGL&);
 };
@@ -19,9 +19,11 @@ extern "C" {
 #include "ccd/ccd.h"
 #include "ccd/quat.h"
 #include <Geo/qhull.h>
+#include <Core/profile.h>
 
 PairCollision::PairCollision(const rai::Mesh &_mesh1, const rai::Mesh &_mesh2, rai::Transformation &_t1, rai::Transformation &_t2, double rad1, double rad2)
   : mesh1(&_mesh1), mesh2(&_mesh2), t1(&_t1), t2(&_t2), rad1(rad1), rad2(rad2) {
+  rai::profileCount("collision/narrowphase");
   
   double d2 = GJK_sqrDistance();
   
@@ -247,10 +249,21 @@ void PairCollision::glDraw(OpenGL &) {
 
 void PairCollision::kinDistance(arr &y, arr &J,
                                 const arr &Jp1, const arr &Jp2) {
-  y = ARR(distance-rad1-rad2);
+  y.resize(1);
+  y.p[0] = distance-rad1-rad2;
   if(!!J) {
-    arr Jdiff = Jp1 - Jp2;
-    J = ~normal*Jdiff;
+    if(isNotSpecial(Jp1) && isNotSpecial(Jp2)) { //J = ~normal*(Jp1-Jp2), without temporaries
+      CHECK(Jp1.d0==3 && Jp2.d0==3 && Jp1.d1==Jp2.d1, "");
+      J.resize(1, Jp1.d1);
+      for(uint i=0; i<J.d1; i++) {
+        double s=0.;
+        for(uint k=0; k<3; k++) s += normal.p[k]*(Jp1.p[k*J.d1+i]-Jp2.p[k*J.d1+i]);
+        J.p[i] = s;
+      }
+    } else {
+      arr Jdiff = Jp1 - Jp2;
+      J = ~normal*Jdiff;
+    }
   }
 }
 
@@ -267,8 +280,8 @@ void PairCollision::kinNormal(arr& y, arr& J,
       J = crossProduct(Jx1, y);
     }
     if(simplexType(2, 2)) {
-      arr a = simplex1[1]-simplex1[0];  a/=length(a);
-      arr b = simplex2[1]-simplex2[0];  b/=length(b);
+      arr3 a = simplex1[1];  a -= simplex1[0];  a/=length(a);
+      arr3 b = simplex2[1];  b -= simplex2[0];  b/=length(b);
       double ab=scalarProduct(a,b);
       if(1.-ab*ab>1e-8) { //the edges are not colinear
         double nn = ::sqrt(1.-ab*ab);
@@ -277,23 +290,23 @@ void PairCollision::kinNormal(arr& y, arr& J,
       }
     }
     if(simplexType(2, 1)) {
-      y = p1 - p2;
+      y = p1;  y -= p2;
       J = Jp1 - Jp2;
       normalizeWithJac(y, J);
-      arr a = simplex1[1]-simplex1[0];  a/=length(a);
+      arr3 a = simplex1[1];  a -= simplex1[0];  a/=length(a);
       J -= a*(~a*J);
       J += a*(~a*crossProduct(Jx1, y));
     }
     if(simplexType(1, 2)) {
-      y = p1 - p2;
+      y = p1;  y -= p2;
       J = Jp1 - Jp2;
       normalizeWithJac(y, J);
-      arr b = simplex2[1]-simplex2[0];  b/=length(b);
+      arr3 b = simplex2[1];  b -= simplex2[0];  b/=length(b);
       J -= b*(~b*J);
       J += b*(~b*crossProduct(Jx2, y));
     }
     if(simplexType(1, 1)) {
-      y = p1 - p2;
+      y = p1;  y -= p2;
       J = Jp1 - Jp2;
       normalizeWithJac(y, J);
     }
@@ -304,7 +317,7 @@ void PairCollision::kinNormal(arr& y, arr& J,
 void PairCollision::kinVector(arr& y, arr& J,
                               const arr &Jp1, const arr &Jp2,
                               const arr &Jx1, const arr &Jx2) {
-  y = p1 - p2;
+  y = p1;  y -= p2;
   if(!!J) {
     J = Jp1 - Jp2;
     if(simplexType(1, 3)) {
@@ -317,8 +330,8 @@ void PairCollision::kinVector(arr& y, arr& J,
     }
     if(simplexType(2, 2)) {
       J = normal*(~normal*J);
-      arr a = simplex1[1]-simplex1[0];  a/=length(a);
-      arr b = simplex2[1]-simplex2[0];  b/=length(b);
+      arr3 a = simplex1[1];  a -= simplex1[0];  a/=length(a);
+      arr3 b = simplex2[1];  b -= simplex2[0];  b/=length(b);
       double ab=scalarProduct(a,b);
       if(1.-ab*ab>1e-8) { //the edges are not colinear
         double nn = ::sqrt(1.-ab*ab);
@@ -327,12 +340,12 @@ void PairCollision::kinVector(arr& y, arr& J,
       }
     }
     if(simplexType(2, 1)) {
-      arr a = simplex1[1]-simplex1[0];  a/=length(a);
+      arr3 a = simplex1[1];  a -= simplex1[0];  a/=length(a);
       J -= a*(~a*J);
       J += a*(~a*crossProduct(Jx1, p1-p2));
     }
     if(simplexType(1, 2)) {
-      arr b = simplex2[1]-simplex2[0];  b/=length(b);
+      arr3 b = simplex2[1];  b -= simplex2[0];  b/=length(b);
       J -= b*(~b*J);
       J += b*(~b*crossProduct(Jx2, p1-p2));
     }
@@ -364,8 +377,8 @@ void PairCollision::kinPointP1(arr& y, arr& J, const arr& Jp1, const arr& Jp2, c
       J += crossProduct(Jx1, p1-p2);
     }
     if(simplexType(2, 2)) {
-      arr a = simplex1[1]-simplex1[0];  a/=length(a);
-      arr b = simplex2[1]-simplex2[0];  b/=length(b);
+      arr3 a = simplex1[1];  a -= simplex1[0];  a/=length(a);
+      arr3 b = simplex2[1];  b -= simplex2[0];  b/=length(b);
       double ab=scalarProduct(a,b);
 
       J = Jp1;
@@ -379,7 +392,7 @@ void PairCollision::kinPointP1(arr& y, arr& J, const arr& Jp1, const arr& Jp2, c
       J -= (1./ac) * (a * ~x) * (eye(3,3) - (1./ac)*c*~a) * Jc;
     }
     if(simplexType(2, 1)) {
-      arr a = simplex1[1]-simplex1[0];  a/=length(a);
+      arr3 a = simplex1[1];  a -= simplex1[0];  a/=length(a);
       J += a*(~a*(Jp2-Jp1));
       J += a*(~a*crossProduct(Jx1, p1-p2));
     }
@@ -397,8 +410,8 @@ void PairCollision::kinPointP2(arr& y, arr& J, const arr& Jp1, const arr& Jp2, c
       J += crossProduct(Jx2, p2-p1);
     }
     if(simplexType(2, 2)) {
-      arr a = simplex2[1]-simplex2[0];  a/=length(a);
-      arr b = simplex1[1]-simplex1[0];  b/=length(b);
+      arr3 a = simplex2[1];  a -= simplex2[0];  a/=length(a);
+      arr3 b = simplex1[1];  b -= simplex1[0];  b/=length(b);
       double ab=scalarProduct(a,b);
 
       J = Jp2;
@@ -412,7 +425,7 @@ void PairCollision::kinPointP2(arr& y, arr& J, const arr& Jp1, const arr& Jp2, c
       J -= (1./ac) * (a * ~x) * (eye(3,3) - (1./ac)*c*~a) * Jc;
     }
     if(simplexType(1, 2)) {
-      arr b = simplex2[1]-simplex2[0];  b/=length(b);
+      arr3 b = simplex2[1];  b -= simplex2[0];  b/=length(b);
       J += b*(~b*(Jp1-Jp2));
       J += b*(~b*crossProduct(Jx2, p2-p1));
     }
@@ -19,6 +19,7 @@
 
 #include "mesh.h"
 #include "qhull.h"
+#include <Core/thread.h>
 
 extern "C" {
 #include <qhull/qhull_a.h>
@@ -324,7 +325,7 @@ double forceClosure(const arr& C, const arr& Cn, const rai::Vector& center,
 
 //===========================================================================
 
-arr getHull(const arr& V, uintA& T) {
+static arr getHull_qhull(const arr& V, uintA& T) {
   auto lock = qhullMutex(RAI_HERE);
   
   int exitcode;
@@ -373,6 +374,77 @@ arr getHull(const arr& V, uintA& T) {
   return Vnew;
 }
 
+/// For large 3D point sets, points that are strictly inside the hull of a few extreme points are
+/// culled in parallel first (Akl-Toussaint heuristic): qhull itself is not reentrant, but then
+/// only runs on the (typically few) remaining points. The resulting hull is the same.
+arr getHull(const arr& V, uintA& T, bool prefilter) {
+  if(!prefilter || V.d1!=3 || V.d0<20000) return getHull_qhull(V, T);
+
+  //-- extreme points along 26 directions, reduced over threads
+  arr dirs;
+  for(int x=-1; x<=1; x++) for(int y=-1; y<=1; y++) for(int z=-1; z<=1; z++) if(x||y||z) dirs.append({double(x), double(y), double(z)});
+  dirs.reshape(-1, 3);
+  uint threads = std::max(1u, std::thread::hardware_concurrency());
+  uint chunk = (V.d0+threads-1)/threads;
+  uintA best(threads, dirs.d0);
+  parallelFor(threads, [&](uint t) {
+    uint start=t*chunk, stop=std::min(V.d0, start+chunk);
+    for(uint d=0; d<dirs.d0; d++) {
+      const double *n=dirs.p+3*d;
+      uint bi=start;
+      double bv=-1e300;
+      for(uint i=start; i<stop; i++) {
+        const double *v=V.p+3*i;
+        double s=n[0]*v[0]+n[1]*v[1]+n[2]*v[2];
+        if(s>bv) { bv=s; bi=i; }
+      }
+      best(t, d)=bi;
+    }
+  }, threads);
+  uintA extremes;
+  for(uint d=0; d<dirs.d0; d++) {
+    uint bi=best(0, d);
+    for(uint t=1; t<threads && t*chunk<V.d0; t++) if(scalarProduct(dirs[d], V[best(t, d)]) > scalarProduct(dirs[d], V[bi])) bi=best(t, d);
+    extremes.setAppendInSorted(bi);
+  }
+  if(extremes.N<4) return getHull_qhull(V, T);
+
+  //-- facets of the hull of the extreme points, oriented outward
+  arr E(extremes.N, 3);
+  for(uint i=0; i<extremes.N; i++) E[i] = V[extremes(i)];
+  uintA ET;
+  arr EH = getHull_qhull(E, ET);
+  if(!ET.d0) return getHull_qhull(V, T); //flat extremes
+  arr center = mean(EH);
+  arr planes(ET.d0, 4);
+  for(uint f=0; f<ET.d0; f++) {
+    arr a=EH[ET(f, 0)], b=EH[ET(f, 1)], c=EH[ET(f, 2)];
+    arr n = crossProduct(b-a, c-a);
+    double l = length(n);
+    if(l<1e-12) { planes[f] = {0., 0., 0., -1.}; continue; } //degenerate: culls nothing
+    n /= l;
+    double off = scalarProduct(n, a);
+    if(scalarProduct(n, center)>off) { n*=-1.; off*=-1.; }
+    planes(f, 0)=n(0); planes(f, 1)=n(1); planes(f, 2)=n(2); planes(f, 3)=off;
+  }
+
+  //-- keep only points on or outside some facet
+  double eps = 1e-10*(1.+absMax(V));
+  byteA keep(V.d0);
+  parallelFor(V.d0, [&](uint i) {
+    const double *v=V.p+3*i;
+    keep.p[i]=0;
+    for(uint f=0; f<planes.d0; f++) {
+      const double *P=planes.p+4*f;
+      if(P[0]*v[0]+P[1]*v[1]+P[2]*v[2] >= P[3]-eps) { keep.p[i]=1; break; }
+    }
+  });
+  arr R;
+  for(uint i=0; i<V.d0; i++) if(keep.p[i]) R.append(V[i]);
+  R.reshape(-1, 3);
+  return getHull_qhull(R, T);
+}
+
 //===========================================================================
 
 void getDelaunayEdges(uintA& E, const arr& V) {
@@ -35,7 +35,7 @@ double forceClosure(const arr& X,  //contact points (size Nx3)
                     double discountTorques=1.,   //friction coefficient
                     arr *dFdX=NULL);    //optional: also compute gradient
 
-arr getHull(const arr& V, uintA& T=NoUintA);
+arr getHull(const arr& V, uintA& T=NoUintA, bool prefilter=true); ///< prefilter: cull interior points of large 3D sets in parallel first
 
 void getDelaunayEdges(uintA& E, const arr& V);
 
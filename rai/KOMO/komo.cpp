@@ -38,6 +38,7 @@
 #include <Kin/TM_NewtonEuler.h>
 #include <Kin/TM_angVel.h>
 #include <Kin/F_pushed.h>
+#include <Core/profile.h>
 
 #ifdef RAI_GL
 #  include <GL/gl.h>
@@ -155,6 +156,9 @@ void KOMO::clearObjectives() {
   listDelete(objectives);
   listDelete(switches);
   listDelete(flags);
+  komo_problem.clear();
+  dense_problem.clear();
+  graph_problem.clear();
 }
 
 Objective *KOMO::addObjective(double startTime, double endTime,
@@ -1398,26 +1402,173 @@ void KOMO::initWithWaypoints(const arrA& waypoints, uint waypointStepsPerPhase,
   reset(0.);
 }
 
+/// true if both configurations have the same frames, parents and joint types (so joint states and features map 1:1)
+static bool sameTopology(const KinematicWorld& A, const KinematicWorld& B) {
+  if(A.frames.N!=B.frames.N) return false;
+  for(uint i=0; i<A.frames.N; i++) {
+    Frame *a=A.frames.elem(i), *b=B.frames.elem(i);
+    if(!a->parent!=!b->parent || (a->parent && a->parent->ID!=b->parent->ID)) return false;
+    if(!a->joint!=!b->joint || (a->joint && a->joint->type!=b->joint->type)) return false;
+  }
+  return true;
+}
+
+/// a feature block in the dual vector: its start index and dimension, objective, and last time slice
+struct DualBlock { uint start, dim, ob; int t; };
+
+/// the feature blocks of the dual vector, keyed by objective index and time slice (banded) or
+/// variable tuple (dense/sparse), with all times shifted by -timeOffset; M returns the total dimension
+static std::map<std::string, DualBlock> getDualIndex(KOMO& komo, int timeOffset, uint& M) {
+  std::map<std::string, DualBlock> index;
+  M=0;
+  bool tuples=false;
+  for(Objective *ob:komo.objectives) if(ob->vars.nd==2) tuples=true;
+  if(!tuples) { //time-major, as in Conv_MotionProblem_KOMO_Problem
+    for(uint t=0; t<komo.T; t++) {
+      WorldL Ktuple = komo.configurations({t, t+komo.k_order});
+      for(uint i=0; i<komo.objectives.N; i++) if(komo.objectives(i)->isActive(t)) {
+        uint m = komo.objectives(i)->map->__dim_phi(Ktuple);
+        index[STRING(i <<':' <<int(t)-timeOffset).p] = {M, m, i, int(t)};
+        M += m;
+      }
+    }
+  } else { //objective-major, as in the dense and graph problems
+    for(uint i=0; i<komo.objectives.N; i++) {
+      Objective *ob = komo.objectives(i);
+      for(uint r=0; r<ob->vars.d0; r++) {
+        uint m = ob->map->__dim_phi(komo.configurations.sub(convert<uint,int>(ob->vars[r]+(int)komo.k_order)));
+        index[STRING(i <<':' <<(ob->vars[r]-timeOffset)).p] = {M, m, i, max(ob->vars[r])};
+        M += m;
+      }
+    }
+  }
+  return index;
+}
+
+void KOMO::initWithPrefix(KOMO& prefix, uint sharedSteps, bool holdRest){
+  CHECK_EQ(prefix.stepsPerPhase, stepsPerPhase, "prefix has different time discretization");
+  CHECK_EQ(prefix.k_order, k_order, "prefix has different order");
+  if(!configurations.N) setupConfigurations();
+  if(sharedSteps>T) sharedSteps=T;
+  if(sharedSteps>prefix.T) sharedSteps=prefix.T;
+
+  //-- copy the solved configurations of the shared steps (as long as the kinematic structure agrees)
+  uint t=0;
+  for(; t<sharedSteps; t++){
+    KinematicWorld *K=configurations(k_order+t), *P=prefix.configurations(k_order+t);
+    if(!sameTopology(*K, *P)) break;
+    K->setJointState(P->getJointState());
+  }
+  sharedSteps=t;
+
+  //-- hold the non-switched DOFs of the remaining steps at the last shared configuration
+  if(holdRest && sharedSteps){
+    KinematicWorld *last = configurations(k_order+sharedSteps-1);
+    for(t=sharedSteps; t<T; t++){
+      uintA nonSwitched = getNonSwitchedBodies({last, configurations(k_order+t)});
+      configurations(k_order+t)->setJointState(last->getJointState(nonSwitched), nonSwitched);
+    }
+  }
+
+  reset(0.);
+
+  //-- duals: feature blocks are identified by objective index and time; only those of the same objective
+  //   entirely within the shared steps are copied
+  if(prefix.dual.N && sparseOptimization==prefix.sparseOptimization && denseOptimization==prefix.denseOptimization){
+    uint prefixM=0, M=0;
+    std::map<std::string, DualBlock> prefixIndex = getDualIndex(prefix, 0, prefixM);
+    if(prefixM!=prefix.dual.N) prefixIndex.clear(); //unknown layout: don't guess
+
+    arr lambda;
+    uint copied=0;
+    for(auto& it:getDualIndex(*this, 0, M)) {
+      if(!lambda.N) lambda = zeros(M);
+      const DualBlock& b = it.second;
+      auto p = prefixIndex.find(it.first);
+      if(!b.dim || b.t>=(int)sharedSteps || p==prefixIndex.end() || p->second.dim!=b.dim) continue;
+      if(objectives(b.ob)->name!=prefix.objectives(p->second.ob)->name) continue;
+      lambda.setVectorBlock(prefix.dual({p->second.start, p->second.start+b.dim-1}), b.start);
+      copied+=b.dim;
+    }
+    if(copied) dual = lambda;
+  }
+
+  //-- start the augmented Lagrangian where the prefix ended
+  if(prefix.muFinal>0.) muInit = prefix.muFinal;
+}
+
+void KOMO::shift(uint steps){
+  CHECK_EQ(configurations.N, k_order+T, "configurations are not setup yet: use komo.reset()");
+  CHECK(steps>0 && steps<T, "can only shift by 1..T-1 steps");
+  for(KinematicWorld *K:configurations)
+    CHECK(sameTopology(*K, *configurations(0)), "shift requires the same kinematic structure in all slices (no switches within the window)");
+
+  //-- the dual's feature blocks before the shift, in the time coordinates after the shift
+  uint prevM=0;
+  std::map<std::string, DualBlock> prevIndex;
+  if(dual.N) prevIndex = getDualIndex(*this, steps, prevM);
+  if(prevM!=dual.N) prevIndex.clear();
+
+  //-- recycle the configurations: the first slices become the new tail
+  std::rotate(configurations.p, configurations.p+steps, configurations.p+configurations.N);
+
+  //-- initialize the new tail slices by constant velocity extrapolation (hold for k_order<2)
+  for(uint s=configurations.N-steps; s<configurations.N; s++) {
+    KinematicWorld *K=configurations(s), *K1=configurations(s-1);
+    arr q = K1->getJointState();
+    if(k_order>1 && s>=2) q += q - configurations(s-2)->getJointState();
+    K->setJointState(q);
+  }
+
+  //-- move the objectives' activity windows
+  for(Objective *ob:objectives) ob->shiftTime(steps, T, k_order);
+
+  //-- warm start: the primal from the shifted configurations; duals of features that remain in the window
+  x = getPath_decisionVariable();
+  if(splineB.N) z = pseudoInverse(splineB) * x;
+  featureValues.clear();
+  featureTypes.clear();
+  komo_problem.clear();
+  dense_problem.clear();
+  graph_problem.clear();
+  if(prevIndex.size()) {
+    uint M=0;
+    arr lambda;
+    for(auto& it:getDualIndex(*this, 0, M)) {
+      if(!lambda.N) lambda = zeros(M);
+      auto prev = prevIndex.find(it.first);
+      uint start=it.second.start, m=it.second.dim;
+      if(m && prev!=prevIndex.end() && prev->second.dim==m)
+        lambda.setVectorBlock(dual({prev->second.start, prev->second.start+m-1}), start);
+    }
+    dual = lambda;
+  } else dual.clear();
+}
+
 void KOMO::run() {
   KinematicWorld::setJointStateCount=0;
   double timeZero = timerStart();
   CHECK(T,"");
+  checkStructure();
   if(logFile) (*logFile) <<"KOMO_run_log: [" <<endl;
   if(opt) delete opt;
+  OptOptions options = NOOPT;
+  if(muInit>0.) options.muInit = muInit;
   if(denseOptimization){
     CHECK(!splineB.N, "NIY");
-    OptConstrained _opt(x, dual, dense_problem, rai::MAX(verbose-2, 0));
+    OptConstrained _opt(x, dual, dense_problem, rai::MAX(verbose-2, 0), options);
 //    OptPrimalDual _opt(x, dual, dense_problem, rai::MAX(verbose-2, 0));
     _opt.logFile = logFile;
     _opt.run();
     timeNewton += _opt.newton.timeNewton;
+    muFinal = _opt.L.mu;
   } else if(sparseOptimization){
     CHECK(!splineB.N, "NIY");
 #if 1
 //    ModGraphProblem selG(graph_problem);
 //    Conv_Graph_ConstrainedProblem C(selG);
     Conv_Graph_ConstrainedProblem C(graph_problem, logFile);
-    OptConstrained _opt(x, dual, C, rai::MAX(verbose-2, 0), NOOPT, logFile);
+    OptConstrained _opt(x, dual, C, rai::MAX(verbose-2, 0), options, logFile);
 //    OptPrimalDual _opt(x, dual, C, rai::MAX(verbose-2, 0));
     _opt.run();
     {
@@ -1428,6 +1579,7 @@ void KOMO::run() {
     }
 
     timeNewton += _opt.newton.timeNewton;
+    muFinal = _opt.L.mu;
 #else
     BacktrackingGraphOptimization BGO(graph_problem);
     BGO.evaluate(x);
@@ -1435,16 +1587,18 @@ void KOMO::run() {
 #endif
   } else if(!splineB.N) { //DEFAULT CASE
     Convert C(komo_problem);
-    opt = new OptConstrained(x, dual, C, rai::MAX(verbose-2, 0));
+    opt = new OptConstrained(x, dual, C, rai::MAX(verbose-2, 0), options);
     opt->logFile = logFile;
     opt->run();
+    muFinal = opt->L.mu;
   } else {
     arr a,b,c,d,e;
     Conv_KOMO_ConstrainedProblem P0(komo_problem);
     Conv_linearlyReparameterize_ConstrainedProblem P(P0, splineB);
-    opt = new OptConstrained(z, dual, P, rai::MAX(verbose-2, 0));
+    opt = new OptConstrained(z, dual, P, rai::MAX(verbose-2, 0), options);
     opt->logFile = logFile;
     opt->run();
+    muFinal = opt->L.mu;
   }
   runTime = timerRead(true, timeZero);
   if(logFile) (*logFile) <<"\n] #end of KOMO_run_log" <<endl;
@@ -1459,6 +1613,7 @@ void KOMO::run() {
 void KOMO::run_sub(const uintA& X, const uintA& Y) {
   KinematicWorld::setJointStateCount=0;
   double timeZero = timerStart();
+  checkStructure();
   if(opt) delete opt;
 
   {
@@ -1578,6 +1733,7 @@ void KOMO::reportProblem(std::ostream& os) {
 
 void KOMO::checkGradients(bool dense) {
   CHECK(T,"");
+  checkStructure();
   if(!splineB.N) {
 #if 0
     checkJacobianCP(Convert(komo_problem), x, 1e-4);
@@ -1787,7 +1943,33 @@ void KOMO::setupConfigurations() {
       sw->apply(*configurations.last());
     }
   }
-  for(uint s=1; s<k_order+T; s++) {
+
+  //-- the topology only changes at slices where a switch or a persistent flag applies: each such slice
+  //   starts a segment and is built (and checked) as template; all other slices of the segment are
+  //   plain copies of the template, whose q and active sets are already consistent
+  uint S = k_order+T;
+  boolA segmentStart = consts<byte>(false, S);
+  if(!sliceTemplates) segmentStart = true;
+  if(S>1) segmentStart(1) = true; //slice 0 may hold switches that have not been followed by calc_q
+  for(KinematicSwitch *sw:switches) {
+    int s = sw->timeOfApplication+(int)k_order;
+    if(s>0 && s<(int)S) segmentStart(s) = true;
+  }
+  for(Flag *fl:flags) {
+    uint s = fl->stepOfApplication+k_order;
+    if(fl->persist && s>0 && s<S) segmentStart(s) = true;
+  }
+
+  KinematicWorld *segmentTemplate = NULL;
+  for(uint s=1; s<S; s++) {
+    if(!segmentStart(s)) {
+      configurations.append(new KinematicWorld())->copy(*segmentTemplate, true);
+      configurations(s)->setTimes(tau);
+#ifndef RAI_NOCHECK //the template was checked when built
+      configurations(s)->checkConsistency();
+#endif
+      continue;
+    }
     configurations.append(new KinematicWorld())->copy(*configurations(s-1), true);
     rai::KinematicWorld& K = *configurations(s);
     K.setTimes(tau); //(tau*(int(s)-int(k_order)));
@@ -1813,6 +1995,7 @@ void KOMO::setupConfigurations() {
 //      rai::wait();
 ////      K.glClose();
 //    }
+    segmentTemplate = &K;
   }
   
   //now apply NON-PERSISTENT flags
@@ -1842,16 +2025,21 @@ void KOMO::set_x(const arr& x, const uintA& selectedConfigurationsOnly) {
     uint s = t+k_order;
     uint x_dim = dim_x(t);
     if(x_dim) {
-      rai::timerRead(true);
+      double time = rai::profileClock();
       if(x.nd==1)  configurations(s)->setJointState(x({x_count, x_count+x_dim-1}), NoArr);
       else         configurations(s)->setJointState(x[t]);
-      timeKinematics += rai::timerRead(true);
+      double dt = rai::profileClock()-time;
+      timeKinematics += dt;
+      rai::profileTime("KOMO/kinematics", dt);
       if(useSwift) {
+        time += dt;
         configurations(s)->stepSwift();
 //        configurations(s)->stepFcl();
         //configurations(s)->proxiesToContacts(1.1);
+        dt = rai::profileClock()-time;
+        timeCollisions += dt;
+        rai::profileTime("KOMO/collisions", dt);
       }
-      timeCollisions += rai::timerRead(true);
       x_count += x_dim;
     }
 //    configurations(s)->checkConsistency();
@@ -2192,38 +2380,75 @@ double KOMO::getCosts(){
   return R.get<double>("sqrCosts");
 }
 
+uint64_t KOMO::getStructureHash() {
+  uint64_t h = 1469598103934665603ull; //FNV-1a
+  auto add = [&h](uint64_t v) { h = (h^v)*1099511628211ull; };
+  add(T);
+  add(k_order);
+  for(KinematicWorld *K:configurations) { add(K->frames.N); add(K->getJointStateDimension()); }
+  for(Objective *ob:objectives) {
+    add((uint64_t)ob);
+    add(typeid(*ob->map).hash_code());
+    add(ob->type);
+    add(ob->map->order);
+    add(ob->vars.nd);
+    for(int v:ob->vars) add(v);
+    add(ob->map->scale.nd==2 ? ob->map->scale.d0 : 0); //matrix scales change the feature dimension
+  }
+  return h;
+}
+
+void KOMO::checkStructure() {
+  uint64_t hash = getStructureHash();
+  if(hash==structureHash) return;
+  komo_problem.dimPhi = 0;
+  dense_problem.dimPhi = 0;
+  graph_problem.dimPhi = 0;
+  structureHash = hash;
+}
+
+void KOMO::retarget(Objective *ob, const arr& target, const arr& scale) {
+  CHECK(objectives.findValue(ob)>=0, "not an objective of this KOMO");
+  if(!!target) ob->map->target = target;
+  if(!!scale) ob->map->scale = scale;
+}
+
 void KOMO::Conv_MotionProblem_KOMO_Problem::getStructure(uintA& variableDimensions, uintA& featureTimes, ObjectiveTypeA& featureTypes) {
   CHECK_EQ(komo.configurations.N, komo.k_order+komo.T, "configurations are not setup yet: use komo.reset()");
-  if(!!variableDimensions) {
-    variableDimensions.resize(komo.T);
-    for(uint t=0; t<komo.T; t++) variableDimensions(t) = komo.configurations(t+komo.k_order)->getJointStateDimension();
-  }
-  
-  if(!!featureTimes) featureTimes.clear();
-  if(!!featureTypes) featureTypes.clear();
-  featureNames.clear();
-  uint M=0;
-  phiIndex.resize(komo.T, komo.objectives.N); phiIndex.setZero();
-  phiDim.resize(komo.T, komo.objectives.N);   phiDim.setZero();
-  for(uint t=0; t<komo.T; t++) {
-    for(uint i=0; i<komo.objectives.N; i++) {
-      Objective *task = komo.objectives.elem(i);
-      if(task->isActive(t)) {
-        uint m = task->map->__dim_phi(komo.configurations({t,t+komo.k_order})); //dimensionality of this task
-        
-        if(!!featureTimes) featureTimes.append(t, m); //consts<uint>(t, m));
-        if(!!featureTypes) featureTypes.append(task->type, m); //consts<ObjectiveType>(task->type, m));
-        for(uint j=0; j<m; j++)  featureNames.append(STRING(task->name <<'_'<<j));
-        
-        //store indexing phi <-> tasks
-        phiIndex(t, i) = M;
-        phiDim(t, i) = m;
-        M += m;
+  if(!dimPhi) {
+    structureVariableDimensions.resize(komo.T);
+    for(uint t=0; t<komo.T; t++) structureVariableDimensions(t) = komo.configurations(t+komo.k_order)->getJointStateDimension();
+    
+    structureFeatureTimes.clear();
+    structureFeatureTypes.clear();
+    featureNames.clear();
+    uint M=0;
+    phiIndex.resize(komo.T, komo.objectives.N); phiIndex.setZero();
+    phiDim.resize(komo.T, komo.objectives.N);   phiDim.setZero();
+    for(uint t=0; t<komo.T; t++) {
+      for(uint i=0; i<komo.objectives.N; i++) {
+        Objective *task = komo.objectives.elem(i);
+        if(task->isActive(t)) {
+          uint m = task->map->__dim_phi(komo.configurations({t,t+komo.k_order})); //dimensionality of this task
+          
+          structureFeatureTimes.append(t, m); //consts<uint>(t, m));
+          structureFeatureTypes.append(task->type, m); //consts<ObjectiveType>(task->type, m));
+          for(uint j=0; j<m; j++)  featureNames.append(STRING(task->name <<'_'<<j));
+          
+          //store indexing phi <-> tasks
+          phiIndex(t, i) = M;
+          phiDim(t, i) = m;
+          M += m;
+        }
       }
     }
-  }
-  dimPhi = M;
-  CHECK_EQ(M, sum(phiDim), "");
+    dimPhi = M;
+    CHECK_EQ(M, sum(phiDim), "");
+  } //otherwise only targets or scales changed since the last call: the structure is reused
+  
+  if(!!variableDimensions) variableDimensions = structureVariableDimensions;
+  if(!!featureTimes) featureTimes = structureFeatureTimes;
+  if(!!featureTypes) featureTypes = structureFeatureTypes;
 }
 
 bool WARN_FIRST_TIME=true;
@@ -2263,6 +2488,8 @@ void KOMO::Conv_MotionProblem_KOMO_Problem::phi(arr& phi, arrA& J, arrA& H, uint
   if(!!J) J.resize(dimPhi);
   if(!!lambda && lambda.N) { lambda.resize(dimPhi); lambda.setZero(); }
   
+  rai::ProfileScope profile("KOMO/phi");
+  const bool profiling = rai::profileEnabled();
   arr y, Jy;
   uint M=0;
   for(uint t=0; t<komo.T; t++) {
@@ -2273,42 +2500,31 @@ void KOMO::Conv_MotionProblem_KOMO_Problem::phi(arr& phi, arrA& J, arrA& H, uint
     for(uint i=0; i<komo.objectives.N; i++) {
       Objective *task = komo.objectives.elem(i);
       if(task->isActive(t)) {
+        double time = profiling ? rai::profileClock() : 0.;
+        
         //query the task map and check dimensionalities of returns
-        task->map->__phi(y, (!!J?Jy:NoArr), Ktuple);
-//        uint m = task->map->__dim_phi(Ktuple);
-//        CHECK_EQ(m,y.N,"");
+        task->map->__phi_raw(y, (!!J?Jy:NoArr), Ktuple);
         if(!!J) CHECK_EQ(y.N, Jy.d0, "");
         if(!!J) CHECK_EQ(Jy.nd, 2, "");
         if(!!J) CHECK_EQ(Jy.d1, Ktuple_dim.last(), "");
+        if(!!J) CHECK(isNotSpecial(Jy), "");
         if(!y.N) continue;
         if(absMax(y)>1e10) RAI_MSG("WARNING y=" <<y);
         
-#if 0
-        //linear transform (target shift)
-        arr target;
-        if(task->target.N==1) target = consts<double>(task->target.scalar(), y.N);
-        else if(task->target.nd==1) target = task->target;
-        else if(task->target.nd==2) target = task->target[t];
-        if(target.N) {
-          if(task->map->flipTargetSignOnNegScalarProduct && scalarProduct(y, target)<-.0) target *= -1.;
-          y -= target;
-        }
-        y *= task->prec(t);
-#endif
-        
-        //write into phi and J
-        phi.setVectorBlock(y, M);
-        if(!!J) {
-//          Jy *= task->prec(t);
-          if(t<komo.k_order) Jy.delColumns(0, Ktuple_dim(komo.k_order-t-1)); //delete the columns that correspond to the prefix!!
-//          if(t<komo.k_order) Jy.delColumns(0,(komo.k_order-t)*komo.configurations(0)->q.N); //delete the columns that correspond to the prefix!!
-          for(uint i=0; i<y.N; i++) J(M+i) = Jy[i]; //copy it to J(M+i); which is the Jacobian of the M+i'th feature w.r.t. its variables
-        }
-        if(!!tt) for(uint i=0; i<y.N; i++) tt(M+i) = task->type;
+        //write the transformed (target, scale) y into phi, and each row of Jy into J(M+i), which is the Jacobian
+        //of the M+i'th feature w.r.t. its variables -- without the columns that correspond to the prefix
+        uint c0 = (t<komo.k_order ? Ktuple_dim(komo.k_order-t-1) : 0);
+        uint m = task->map->__writeLinearTrans(phi.p+M, y, (!!J?Jy:NoArr), 1., [&J, &Jy, M, c0](uint i, double f) {
+          arr& row = J(M+i);
+          row.resize(Jy.d1-c0);
+          const double *src = Jy.p+i*Jy.d1+c0;
+          for(uint c=0; c<row.N; c++) row.p[c] = f*src[c];
+        });
+        if(!!tt) for(uint i=0; i<m; i++) tt(M+i) = task->type;
         
         //transfer Lambda values
-        if(!!lambda && lambda.N && y.N==prevPhiDim(t,i)) {
-          lambda.setVectorBlock(prevLambda({prevPhiIndex(t,i), prevPhiIndex(t,i)+y.N-1}), M);
+        if(!!lambda && lambda.N && m==prevPhiDim(t,i)) {
+          lambda.setVectorBlock(prevLambda({prevPhiIndex(t,i), prevPhiIndex(t,i)+m-1}), M);
         }
         
 //        //store indexing phi <-> tasks
@@ -2316,7 +2532,13 @@ void KOMO::Conv_MotionProblem_KOMO_Problem::phi(arr& phi, arrA& J, arrA& H, uint
 //        phiDim(t, i) = y.N;
 
         //counter for features phi
-        M += y.N;
+        M += m;
+        
+        if(profiling) { //per objective and per feature type
+          time = rai::profileClock()-time;
+          rai::profileTime("KOMO/objective/", task->name, time);
+          rai::profileTime("KOMO/feature/", rai::profileTypeName(typeid(*task->map)), time);
+        }
       }
     }
   }
@@ -2401,42 +2623,29 @@ void KOMO::Conv_MotionProblem_DenseProblem::phi(arr& phi, arr& J, arr& H, Object
       kdim.prepend(0);
 
       //query the task map and check dimensionalities of returns
-      task->map->__phi(y, (!!J?Jy:NoArr), Ktuple);
+      task->map->__phi_raw(y, (!!J?Jy:NoArr), Ktuple);
       if(!!J) CHECK_EQ(y.N, Jy.d0, "");
       if(!!J) CHECK_EQ(Jy.nd, 2, "");
       if(!!J) CHECK_EQ(Jy.d1, kdim.last(), "");
+      if(!!J) CHECK(isNotSpecial(Jy), "");
       if(!y.N) continue;
       if(absMax(y)>1e10) RAI_MSG("WARNING y=" <<y);
 
-#if 0
-      //linear transform (target shift)
-      arr target;
-      if(task->target.N==1) target = consts<double>(task->target.scalar(), y.N);
-      else if(task->target.nd==1) target = task->target;
-      else if(task->target.nd==2) target = task->target[t];
-      if(target.N) {
-        if(task->map->flipTargetSignOnNegScalarProduct && scalarProduct(y, target)<-.0) target *= -1.;
-        y -= target;
-      }
-      y *= task->prec(t);
-#endif
-
-      //write into phi and J
-      phi.setVectorBlock(y, M);
-
-      if(!!J) {
-//        Jy *= task->prec(t);
+      //write the transformed (target, scale) y into phi, and the column blocks of Jy into the blocks of J of the respective variables
+      uint m = task->map->__writeLinearTrans(phi.p+M, y, (!!J?Jy:NoArr), 1., [&](uint i, double f) {
+        const double *src = Jy.p+i*Jy.d1;
         for(uint j=0;j<task->vars.d1;j++){
           if(task->vars(t,j)>=0){
-            J.setMatrixBlock(Jy.sub(0,-1,kdim(j),kdim(j+1)-1), M, x_index(task->vars(t,j)));
+            double *dst = J.p+(M+i)*J.d1+x_index(task->vars(t,j));
+            for(uint c=kdim(j); c<kdim(j+1); c++) *(dst++) = f*src[c];
           }
         }
-      }
+      });
 
-      if(!!tt) for(uint i=0; i<y.N; i++) tt(M+i) = task->type;
+      if(!!tt) for(uint i=0; i<m; i++) tt(M+i) = task->type;
 
       //counter for features phi
-      M += y.N;
+      M += m;
     }
   }
 
@@ -2474,28 +2683,32 @@ void KOMO::Conv_MotionProblem_DenseProblem::getDimPhi() {
 
 void KOMO::Conv_MotionProblem_GraphProblem::getStructure(uintA& variableDimensions, intAA& featureVariables, ObjectiveTypeA& featureTypes) {
   CHECK_EQ(komo.configurations.N, komo.k_order+komo.T, "configurations are not setup yet: use komo.reset()");
-  if(!!variableDimensions) {
-    variableDimensions.resize(komo.T);
-    for(uint t=0; t<komo.T; t++) variableDimensions(t) = komo.configurations(t+komo.k_order)->getJointStateDimension();
-  }
-
-  if(!!featureVariables) featureVariables.clear();
-  if(!!featureTypes) featureTypes.clear();
-  uint M=0;
-  for(Objective *ob:komo.objectives) {
-    CHECK_EQ(ob->vars.nd, 2, "in sparse mode, vars need to be tuples of variables");
-    for(uint t=0;t<ob->vars.d0;t++) {
-      WorldL Ktuple = komo.configurations.sub(convert<uint,int>(ob->vars[t]+(int)komo.k_order));
-      uint m = ob->map->__dim_phi(Ktuple); //dimensionality of this task
-      if(!!featureVariables) featureVariables.append(ob->vars[t], m);
-      if(!!featureTypes) featureTypes.append(ob->type, m);
-      M += m;
+  if(!dimPhi) {
+    structureVariableDimensions.resize(komo.T);
+    for(uint t=0; t<komo.T; t++) structureVariableDimensions(t) = komo.configurations(t+komo.k_order)->getJointStateDimension();
+    
+    structureFeatureVariables.clear();
+    structureFeatureTypes.clear();
+    uint M=0;
+    for(Objective *ob:komo.objectives) {
+      CHECK_EQ(ob->vars.nd, 2, "in sparse mode, vars need to be tuples of variables");
+      for(uint t=0;t<ob->vars.d0;t++) {
+        WorldL Ktuple = komo.configurations.sub(convert<uint,int>(ob->vars[t]+(int)komo.k_order));
+        uint m = ob->map->__dim_phi(Ktuple); //dimensionality of this task
+        structureFeatureVariables.append(ob->vars[t], m);
+        structureFeatureTypes.append(ob->type, m);
+        M += m;
+      }
     }
+    dimPhi = M;
+  } //otherwise only targets or scales changed since the last call: the structure is reused
+  
+  if(!!variableDimensions) variableDimensions = structureVariableDimensions;
+  if(!!featureVariables) featureVariables = structureFeatureVariables;
+  if(!!featureTypes) {
+    featureTypes = structureFeatureTypes;
+    komo.featureTypes = featureTypes;
   }
-
-  if(!!featureTypes) komo.featureTypes = featureTypes;
-
-  dimPhi = M;
 }
 
 void KOMO::Conv_MotionProblem_GraphProblem::getSemantics(StringA& varNames, StringA& phiNames){
@@ -2528,7 +2741,8 @@ void KOMO::Conv_MotionProblem_GraphProblem::phi(arr& phi, arrA& J, arrA& H, cons
 //  uintA x_index = getKtupleDim(komo.configurations({komo.k_order,-1}));
 //  x_index.prepend(0);
 
-  rai::timerStart();
+  rai::ProfileScope profile("KOMO/phi");
+  double time = rai::profileClock();
   arr y, Jy;
   uint M=0;
   for(Objective *ob:komo.objectives) {
@@ -2540,31 +2754,34 @@ void KOMO::Conv_MotionProblem_GraphProblem::phi(arr& phi, arrA& J, arrA& H, cons
       kdim.prepend(0);
 
       //query the task map and check dimensionalities of returns
-      ob->map->__phi(y, (!!J?Jy:NoArr), Ktuple);
+      ob->map->__phi_raw(y, (!!J?Jy:NoArr), Ktuple);
 
       if(!!J) CHECK_EQ(y.N, Jy.d0, "");
       if(!!J) CHECK_EQ(Jy.nd, 2, "");
       if(!!J) CHECK_EQ(Jy.d1, kdim.last(), "");
+      if(!!J) CHECK(isNotSpecial(Jy), "");
       if(!y.N) continue;
       if(absMax(y)>1e10) RAI_MSG("WARNING y=" <<y);
 
-      //write into phi and J
-      phi.setVectorBlock(scale * y, M); // appy scale on y
-
-      if(!!J) {
-        for(uint j=ob->vars.d1;j--;){
-          if(ob->vars(t,j)<0){
-            Jy.delColumns(kdim(j),kdim(j+1)-kdim(j)); //delete the columns that correspond to the prefix!!
-          }
+      //write the transformed (target, scale, and the slice scale) y into phi, and each row of Jy into J(M+i),
+      //without the columns that correspond to the prefix
+      uint m = ob->map->__writeLinearTrans(phi.p+M, y, (!!J?Jy:NoArr), scale, [&](uint i, double f) {
+        uint n=0;
+        for(uint j=0;j<ob->vars.d1;j++) if(ob->vars(t,j)>=0) n += kdim(j+1)-kdim(j);
+        arr& row = J(M+i);
+        row.resize(n);
+        const double *src = Jy.p+i*Jy.d1;
+        double *dst = row.p;
+        for(uint j=0;j<ob->vars.d1;j++){
+          if(ob->vars(t,j)>=0) for(uint c=kdim(j); c<kdim(j+1); c++) *(dst++) = f*src[c];
         }
-        for(uint i=0; i<y.N; i++) J(M+i) = scale * Jy[i]; // appy scale on J
-      }
+      });
 
       //counter for features phi
-      M += y.N;
+      M += m;
     }
   }
-  komo.timeFeatures += rai::timerRead(true);
+  komo.timeFeatures += rai::profileClock()-time;
 
   CHECK_EQ(M, dimPhi, "");
   //  if(!!lambda) CHECK_EQ(prevLambda, lambda, ""); //this ASSERT only holds is none of the tasks is variable dim!
@@ -84,12 +84,15 @@ struct KOMO : NonCopyable {
   WorldL configurations;       ///< copies for each time slice; including kinematic switches; only these are optimized
   bool useSwift;               ///< whether swift (collisions/proxies) is evaluated whenever new configurations are set (needed if tasks read proxy list)
   bool useSwitches;            ///< if true, switches change kinematic topology; if false, switches only impose relative pose constraints
+  bool sliceTemplates=true;    ///< setupConfigurations copies slices without switches/persistent flags from their segment's first slice; if false, every slice is built from its predecessor
 
   //-- optimizer
   bool denseOptimization=false;///< calls optimization with a dense (instead of banded) representation
   bool sparseOptimization=false;///< calls optimization with a sparse (instead of banded) representation
   OptConstrained *opt=0;       ///< optimizer; created in run()
   arr x, dual;                 ///< the primal and dual solution
+  double muInit=-1.;           ///< if >0: initial penalty of the augmented Lagrangian (e.g. from a warm start), instead of opt/muInit
+  double muFinal=-1.;          ///< the penalty of the augmented Lagrangian at the end of the last run()
   arr z, splineB;              ///< when a spline representation is used: z are the nodes; splineB the B-spline matrix; x = splineB * z
   //return values
   double sos, eq, ineq;
@@ -242,9 +245,12 @@ struct KOMO : NonCopyable {
   void reset(double initNoise=.01);  ///< reset the optimizer (initializes x to a default path)
   void initWithConstant(const arr& q);
   void initWithWaypoints(const arrA& waypoints, uint waypointStepsPerPhase=1, bool sineProfile=true);
+  void initWithPrefix(KOMO& prefix, uint sharedSteps, bool holdRest=true); ///< warm start from a solved KOMO that shares the first sharedSteps (same skeleton prefix)
+  void shift(uint steps=1);          ///< receding horizon: moves the time window 'steps' slices forward, recycling the configurations, objective windows, x and dual (requires the same frames, parents and joint types in all slices, i.e., no switches within the window)
   void run();                        ///< run the optimization (using OptConstrained -- its parameters are read from the cfg file)
   void run_sub(const uintA& X, const uintA& Y);
   void optimize(bool initialize=true);
+  void retarget(Objective *ob, const arr& target=NoArr, const arr& scale=NoArr); ///< change an objective's target/scale in place; a following optimize(false) reuses the problem structure
 
   rai::KinematicWorld& getConfiguration(double phase);
   arr getJointState(double phase);
@@ -289,12 +295,17 @@ struct KOMO : NonCopyable {
   void set_x(const arr& x, const uintA& selectedConfigurationsOnly=NoUintA);            ///< set the state trajectory of all configurations
   uint dim_x(uint t) { return configurations(t+k_order)->getJointStateDimension(); }
 
+  uint64_t getStructureHash(); ///< hash of everything that determines the feature layout (objective windows and types, linear transformation dims, slice dimensions), but not targets/scales
+  void checkStructure();       ///< called once per run: drops the problems' cached structure if getStructureHash() changed
+  
   struct Conv_MotionProblem_KOMO_Problem : KOMO_Problem {
     KOMO& komo;
-    uint dimPhi;
+    uint dimPhi=0;
     arr prevLambda;
     uintA phiIndex, phiDim;
     StringA featureNames;
+    uintA structureVariableDimensions, structureFeatureTimes; ///< reused until checkStructure() resets dimPhi
+    ObjectiveTypeA structureFeatureTypes;
     
     Conv_MotionProblem_KOMO_Problem(KOMO& _komo) : komo(_komo) {}
     void clear(){ dimPhi=0; prevLambda.clear(); phiIndex.clear(); phiDim.clear(); featureNames.clear(); }
@@ -319,6 +330,9 @@ struct KOMO : NonCopyable {
   struct Conv_MotionProblem_GraphProblem : GraphProblem {
     KOMO& komo;
     uint dimPhi=0;
+    uintA structureVariableDimensions; ///< reused until checkStructure() resets dimPhi
+    intAA structureFeatureVariables;
+    ObjectiveTypeA structureFeatureTypes;
 
     Conv_MotionProblem_GraphProblem(KOMO& _komo) : komo(_komo) {}
     void clear(){ dimPhi=0; }
@@ -330,5 +344,6 @@ struct KOMO : NonCopyable {
     virtual void getPartialPhi(arr& phi, arrA& J, arrA& H, const uintA& whichPhi);
     virtual void getSemantics(StringA& varNames, StringA& phiNames);
   } graph_problem;
+  uint64_t structureHash=0; ///< getStructureHash() at the last checkStructure()
 };
 
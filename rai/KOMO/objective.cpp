@@ -51,6 +51,32 @@ void Objective::setCostSpecs(double fromTime, double toTime, int stepsPerPhase,
   setCostSpecs(fromStep, toStep, sparse);
 }
 
+void Objective::shiftTime(uint steps, uint T, uint k_order) {
+  if(!vars.N) return;
+  if(vars.nd==1) { //(0,1)-indicator per time slice
+    if(vars.N>=T && vars(T-1)) return; //anchored at the end of the horizon
+    intA v(T);
+    v.setZero();
+    for(uint t=0; t<T && t+steps<vars.N; t++) v(t) = vars(t+steps);
+    vars = v;
+  } else { //variable tuples; tuples reaching before the prefix are dropped
+    CHECK_EQ(vars.nd, 2, "");
+    if(max(vars)==int(T)-1) return; //anchored at the end of the horizon
+    bool hasScales = (scales.N==vars.d0);
+    intA v;
+    arr s;
+    uint d1 = vars.d1;
+    for(uint i=0; i<vars.d0; i++) {
+      intA tuple = vars[i]-int(steps);
+      if(min(tuple)<-int(k_order)) continue;
+      v.append(tuple);
+      if(hasScales) s.append(scales(i));
+    }
+    vars = v.reshape(v.N/d1, d1);
+    if(hasScales) scales = s;
+  }
+}
+
 bool Objective::isActive(uint t) {
   if(!vars.N) return false;
   CHECK_EQ(vars.nd, 1, "variables are not time indexed (tuples for dense problem instead)");
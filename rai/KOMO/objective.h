@@ -23,6 +23,7 @@ struct Objective {
   void setCostSpecs(int fromStep, int toStep, bool sparse=false);
   void setCostSpecs(double fromTime, double toTime, int stepsPerPhase, uint T,
                     int deltaFromStep=0, int deltaToStep=0, bool sparse=false);
+  void shiftTime(uint steps, uint T, uint k_order); ///< moves the activity window 'steps' slices earlier (receding horizon); windows that reach the last slice stay anchored to the horizon's end
   bool isActive(uint t);
   void write(std::ostream& os) const;
 };
@@ -0,0 +1,211 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2017 Marc Toussaint
+    email: marc.toussaint@informatik.uni-stuttgart.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "parallelRRT.h"
+
+#include <Kin/kin.h>
+#include <Kin/proxy.h>
+#include <Algo/rrt.h>
+#include <Core/thread.h>
+
+namespace rai {
+
+/// one tree with the lazy validation state of each node's edge to its parent
+struct LazyTree {
+  RRT rrt;
+  intA edge;  ///< 0=unchecked, 1=valid, -1=invalid
+  LazyTree(const arr& q0, double stepsize) : rrt(q0, stepsize) { edge.append(1); }
+  uint add(const arr& q, uint parent) { edge.append(0); return rrt.add(q, parent); }
+  bool isDead(uint i) { //is there an invalid edge on the way to the root?
+    for(;;) {
+      if(edge(i)<0) return true;
+      if(!i) return false;
+      i=rrt.getParent(i);
+    }
+  }
+  uintA branch(uint i) { //the nodes from i down to the root
+    uintA B;
+    for(;;) { B.append(i); if(!i) break; i=rrt.getParent(i); }
+    return B;
+  }
+};
+
+struct sParallelRRTPlanner {
+  rai::Array<KinematicWorld*> worlds; ///< one per worker
+
+  ~sParallelRRTPlanner() { for(KinematicWorld *K:worlds) delete K; }
+
+  bool check(uint w, const arr& q, bool useFcl) {
+    KinematicWorld& K = *worlds(w);
+    K.setJointState(q);
+    if(useFcl) { K.stepFcl(); return !K.proxies.N; }
+    K.stepSwift();
+    return K.totalContactPenetration()<=0.;
+  }
+
+  /// calls f(i, w) for i=0..n-1, with contiguous chunks of i distributed over the workers w
+  template<class F> void forWorkers(uint n, const F& f) {
+    uint W = std::min(worlds.N, n);
+    if(!W) return;
+    uint chunk = (n+W-1)/W;
+    parallelFor(W, [&f, n, chunk](uint w) {
+      for(uint i=w*chunk; i<n && i<(w+1)*chunk; i++) f(i, w);
+    }, W);
+  }
+};
+
+//interior configurations of the edge q0->q1 (the end points are checked as nodes)
+void interpolateEdge(arr& Q, const arr& q0, const arr& q1, double resolution) {
+  uint m = ceil(length(q1-q0)/resolution);
+  for(uint k=1; k<m; k++) Q.append(q0 + (double(k)/m) * (q1-q0));
+}
+
+}
+
+rai::ParallelRRTPlanner::ParallelRRTPlanner(const KinematicWorld& K, double _stepsize, uint threads)
+  : s(new sParallelRRTPlanner), stepsize(_stepsize), edgeResolution(.1*_stepsize) {
+  if(!threads) threads = std::max(1u, std::thread::hardware_concurrency());
+  for(uint w=0; w<threads; w++) s->worlds.append(new KinematicWorld(K));
+  limits = K.getLimits();
+}
+
+rai::ParallelRRTPlanner::~ParallelRRTPlanner() {
+  delete s;
+}
+
+bool rai::ParallelRRTPlanner::isFeasible(const arr& q) {
+  return s->check(0, q, useFcl);
+}
+
+void rai::ParallelRRTPlanner::areFeasible(byteA& feasible, const arr& Q) {
+  feasible.resize(Q.d0);
+  s->forWorkers(Q.d0, [this, &feasible, &Q](uint i, uint w) {
+    feasible.p[i] = s->check(w, Q[i], useFcl);
+  });
+}
+
+bool rai::ParallelRRTPlanner::isFeasibleEdge(const arr& q0, const arr& q1) {
+  arr Q;
+  interpolateEdge(Q, q0, q1, edgeResolution);
+  if(!Q.N) return true;
+  Q.reshape(-1, q0.N);
+  byteA feasible;
+  areFeasible(feasible, Q);
+  for(byte f:feasible) if(!f) return false;
+  return true;
+}
+
+arr rai::ParallelRRTPlanner::planPath(const arr& q0, const arr& qT, uint maxIters) {
+  if(!isFeasible(q0) || !isFeasible(qT)) return arr();
+  uint n = q0.N;
+  CHECK_EQ(limits.d0, n, "limits have wrong dimension");
+  if(isFeasibleEdge(q0, qT)) return cat(q0, qT).reshape(2, n);
+
+  LazyTree A(q0, stepsize), B(qT, stepsize);
+  uint batch = s->worlds.N*samplesPerWorker;
+  arr samples(batch, n), proposals(batch, n);
+  uintA parents(batch), nearestO(batch);
+  byteA ok(batch);
+
+  for(uint iter=0; iter<maxIters; iter++) {
+    LazyTree& T = (iter%2) ? B : A;
+    LazyTree& O = (iter%2) ? A : B;
+
+    //sample (sequentially: the random generator is not thread-safe)
+    for(uint i=0; i<batch; i++) {
+      if(rnd.uni()<goalBias) samples[i] = O.rrt.getRandomNode();
+      else for(uint j=0; j<n; j++) samples(i, j) = limits(j, 0) + rnd.uni()*(limits(j, 1)-limits(j, 0));
+    }
+
+    //extend: the nearest nodes of the whole batch in one index query, then proposals and checks on the workers
+    T.rrt.getNearest(parents, samples, s->worlds.N);
+    s->forWorkers(batch, [this, &T, &samples, &proposals, &parents, &ok](uint i, uint w) {
+      arr prop;
+      T.rrt.getProposalFrom(prop, parents.p[i], samples[i]);
+      proposals[i] = prop;
+      ok.p[i] = !T.isDead(parents.p[i]) && s->check(w, prop, useFcl);
+    });
+
+    //add nodes and test connections to the other tree (whose nodes do not change meanwhile: one batch query)
+    O.rrt.getNearest(nearestO, proposals, s->worlds.N);
+    for(uint i=0; i<batch; i++) if(ok(i)) {
+      uint a = T.add(proposals[i], parents(i));
+      arr tmp;
+      uint b = nearestO(i);
+      if(O.rrt.getProposalFrom(tmp, b, proposals[i]) > stepsize || O.isDead(b)) continue;
+
+      //lazy validation of all unchecked edges of this path candidate, in one batch
+      uintA branchT = T.branch(a), branchO = O.branch(b);
+      arr Q;
+      intA edgeOf; //for each configuration in Q: which edge (+1: of T, -1: of O, 0: the connection)
+      interpolateEdge(Q, T.rrt.getNode(a), O.rrt.getNode(b), edgeResolution);
+      edgeOf.resize(Q.N/n).setZero();
+      for(uint k=0; k+1<branchT.N; k++) if(!T.edge(branchT(k))) {
+        interpolateEdge(Q, T.rrt.getNode(branchT(k+1)), T.rrt.getNode(branchT(k)), edgeResolution);
+        while(edgeOf.N<Q.N/n) edgeOf.append(branchT(k)+1);
+      }
+      for(uint k=0; k+1<branchO.N; k++) if(!O.edge(branchO(k))) {
+        interpolateEdge(Q, O.rrt.getNode(branchO(k+1)), O.rrt.getNode(branchO(k)), edgeResolution);
+        while(edgeOf.N<Q.N/n) edgeOf.append(-int(branchO(k))-1);
+      }
+      byteA feasible;
+      if(Q.N) { Q.reshape(-1, n); areFeasible(feasible, Q); }
+
+      bool connected=true;
+      for(uint k=0; k<branchT.N; k++) if(!T.edge(branchT(k))) T.edge(branchT(k))=1;
+      for(uint k=0; k<branchO.N; k++) if(!O.edge(branchO(k))) O.edge(branchO(k))=1;
+      for(uint k=0; k<feasible.N; k++) if(!feasible(k)) {
+        connected=false;
+        int e=edgeOf(k);
+        if(e>0) T.edge(e-1)=-1;
+        if(e<0) O.edge(-e-1)=-1;
+      }
+      if(verbose) cout <<"RRT iter=" <<iter <<" candidate path checked (" <<Q.d0 <<" configurations): " <<(connected?"valid":"invalid") <<endl;
+      if(!connected) continue;
+
+      //assemble the path from q0 to qT
+      uintA& branchA = (&T==&A) ? branchT : branchO;
+      uintA& branchB = (&T==&A) ? branchO : branchT;
+      arr path;
+      for(uint k=branchA.N; k--;) path.append(A.rrt.getNode(branchA(k)));
+      for(uint k=0; k<branchB.N; k++) path.append(B.rrt.getNode(branchB(k)));
+      path.reshape(-1, n);
+      if(verbose) cout <<"RRT found path after " <<iter+1 <<" rounds, #nodes=" <<A.rrt.getNumberNodes()+B.rrt.getNumberNodes() <<endl;
+      return path;
+    }
+  }
+  if(verbose) cout <<"RRT failed after " <<maxIters <<" rounds" <<endl;
+  return arr();
+}
+
+void rai::ParallelRRTPlanner::shortcut(arr& path, uint iters) {
+  for(uint k=0; k<iters && path.d0>2; k++) {
+    uint i=rnd(path.d0), j=rnd(path.d0);
+    if(i>j) std::swap(i, j);
+    if(j<i+2) continue;
+    if(isFeasibleEdge(path[i], path[j])) path.delRows(i+1, j-i-1);
+  }
+}
+
+arrA rai::ParallelRRTPlanner::getWaypoints(const arr& path, uint n) {
+  CHECK_GE(path.d0, 2, "");
+  arr cum(path.d0);
+  cum(0)=0.;
+  for(uint t=1; t<path.d0; t++) cum(t) = cum(t-1) + length(path[t]-path[t-1]);
+  arrA waypoints(n);
+  uint t=1;
+  for(uint i=0; i<n; i++) {
+    double l = cum.last()*double(i+1)/n;
+    while(t+1<path.d0 && cum(t)<l) t++;
+    double seg = cum(t)-cum(t-1);
+    double a = seg>0. ? (l-cum(t-1))/seg : 1.;
+    if(a>1.) a=1.;
+    waypoints(i) = path[t-1] + a*(path[t]-path[t-1]);
+  }
+  return waypoints;
+}
@@ -0,0 +1,48 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2017 Marc Toussaint
+    email: marc.toussaint@informatik.uni-stuttgart.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include <Core/array.h>
+
+namespace rai {
+struct KinematicWorld;
+
+/// bidirectional RRT in joint space, built on the RRT primitives of Algo/rrt.h.
+/// Samples are drawn and extended in batches: one nearest-neighbor query per batch and tree (Algo/ann.h getkNN_batch), then
+/// the proposals and their collision checks run on parallel workers, each
+/// owning a copy of the world (and thereby its own collision engine instance). New nodes are only checked as points;
+/// edges are validated lazily: once the trees connect, all unchecked edges of that path candidate
+/// are interpolated and checked in one parallel batch. A failed edge cuts off its subtree.
+struct ParallelRRTPlanner {
+private:
+  struct sParallelRRTPlanner *s;
+public:
+  arr limits;              ///< (n x 2) sampling range of each joint [default: K.getLimits()]
+  double stepsize;         ///< maximal extension of a tree per sample
+  double edgeResolution;   ///< maximal distance between checked configurations along an edge [default: stepsize/10]
+  double goalBias=.1;      ///< probability to sample towards a node of the other tree
+  uint samplesPerWorker=4; ///< batch size of one extension round per worker
+  bool useFcl=false;       ///< collision checks via stepFcl instead of stepSwift
+  bool verbose=false;
+
+  ParallelRRTPlanner(const KinematicWorld& K, double _stepsize, uint threads=0); ///< threads=0: hardware concurrency
+  ~ParallelRRTPlanner();
+
+  bool isFeasible(const arr& q);
+  void areFeasible(byteA& feasible, const arr& Q); ///< checks all rows of Q, distributed over the workers
+  bool isFeasibleEdge(const arr& q0, const arr& q1);
+
+  arr planPath(const arr& q0, const arr& qT, uint maxIters=1000); ///< (N x n) path from q0 to qT; empty if none found
+  void shortcut(arr& path, uint iters=50);                         ///< random shortcutting of a feasible path
+
+  /// resamples the path equidistantly (by arc length) into n waypoints, excluding q0 -- to seed KOMO::initWithWaypoints
+  static arrA getWaypoints(const arr& path, uint n);
+};
+
+}
@@ -0,0 +1,131 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2017 Marc Toussaint
+    email: marc.toussaint@informatik.uni-stuttgart.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "TM_SweptPairCollision.h"
+#include <Geo/pairCollision.h>
+
+//returns the core mesh (and radius) of the shape at both poses, stacked: the first n vertices are slice 0
+static void getSweptCore(rai::Mesh& M, double& r, rai::Frame *f0, rai::Frame *f1, bool neglectRadius) {
+  rai::Shape *s0 = f0->shape, *s1 = f1->shape;
+  CHECK(s0 && s1, "swept collision requires shapes in both slices");
+  r = s1->radius();
+  rai::Mesh *c0 = &s0->sscCore(), *c1 = &s1->sscCore();
+  if(!c1->V.N) { c0 = &s0->mesh(); c1 = &s1->mesh(); r=0.; }
+  if(!c0->V.N) c0->V = zeros(1,3);
+  if(!c1->V.N) c1->V = zeros(1,3);
+  if(neglectRadius) r=0.;
+
+  arr V1 = c1->V;
+  M.V = c0->V;
+  f0->X.applyOnPointArray(M.V);
+  f1->X.applyOnPointArray(V1);
+  M.V.append(V1);
+  M.V.reshape(-1, 3);
+}
+
+//barycentric coordinates of p w.r.t. the (up to 4) simplex points; p is projected onto their affine hull
+static arr barycentric(const arr& p, const arr& S) {
+  uint n=S.d0;
+  CHECK(n>=1 && n<=4, "simplex with " <<n <<" points");
+  if(n==1) return {1.};
+  //least squares in the edge vectors: (A^T A) u = A^T (p-S0), with A = [S1-S0, ..]
+  arr A(n-1, 3);
+  for(uint k=1; k<n; k++) A[k-1] = S[k]-S[0];
+  arr AAt = A*~A, Ad = A*(p-S[0]);
+  arr u;
+  if(n==2) {
+    double t = (AAt(0,0)>1e-20 ? Ad(0)/AAt(0,0) : 0.);
+    u = {rai::MIN(1., rai::MAX(0., t))};
+  } else {
+    if(fabs(determinant(AAt))<1e-20) return consts<double>(1./n, n); //degenerate simplex
+    u = inverse(AAt)*Ad;
+  }
+  arr lambda(n);
+  lambda(0) = 1.-sum(u);
+  for(uint k=1; k<n; k++) lambda(k) = u(k-1);
+  return lambda;
+}
+
+//Jacobian of the witness point p of a swept mesh: p is a convex combination of simplex vertices,
+//each of which moves rigidly with the frame of its slice
+static void sweptPointJacobian(arr& Jp, const arr& p, const arr& simplex, const rai::Mesh& M, rai::Frame *f0, rai::Frame *f1, const WorldL& Ktuple) {
+  if(!simplex.d0) {
+    f1->K.jacobianPos(Jp, f1, p);
+    expandJacobian(Jp, Ktuple, -1);
+    return;
+  }
+  arr lambda = barycentric(p, simplex);
+  uint n = M.V.d0/2;
+  Jp.clear();
+  for(uint k=0; k<simplex.d0; k++) {
+    //find the vertex, to decide from which slice it stems
+    uint best=0;
+    double dBest=-1.;
+    for(uint v=0; v<M.V.d0; v++) {
+      double d = sqrDistance(simplex[k], M.V[v]);
+      if(dBest<0. || d<dBest) { dBest=d; best=v; }
+    }
+    arr Jk;
+    if(best<n) { f0->K.jacobianPos(Jk, f0, simplex[k]);  expandJacobian(Jk, Ktuple, -2); }
+    else       { f1->K.jacobianPos(Jk, f1, simplex[k]);  expandJacobian(Jk, Ktuple, -1); }
+    if(!Jp.N) Jp = lambda(k)*Jk;
+    else Jp += lambda(k)*Jk;
+  }
+}
+
+TM_SweptPairCollision::TM_SweptPairCollision(int _i, int _j, bool _neglectRadii)
+  : i(_i), j(_j), neglectRadii(_neglectRadii) {
+  order=1;
+}
+
+TM_SweptPairCollision::TM_SweptPairCollision(const rai::KinematicWorld& K, const char* s1, const char* s2, bool _neglectRadii)
+  : i(initIdArg(K, s1)), j(initIdArg(K, s2)), neglectRadii(_neglectRadii) {
+  CHECK_GE(i, 0,"shape name '" <<s1 <<"' does not exist");
+  CHECK_GE(j, 0,"shape name '" <<s2 <<"' does not exist");
+  order=1;
+}
+
+TM_SweptPairCollision::~TM_SweptPairCollision(){
+  if(coll) delete coll;
+}
+
+void TM_SweptPairCollision::phi(arr& y, arr& J, const WorldL& Ktuple) {
+  CHECK_GE(Ktuple.N, 2, "swept collision needs two consecutive configurations");
+  const rai::KinematicWorld& K0 = *Ktuple(-2);
+  const rai::KinematicWorld& K1 = *Ktuple(-1);
+  rai::Frame *a0 = K0.frames(i), *a1 = K1.frames(i);
+  rai::Frame *b0 = K0.frames(j), *b1 = K1.frames(j);
+
+  double r1, r2;
+  getSweptCore(m1, r1, a0, a1, neglectRadii);
+  getSweptCore(m2, r2, b0, b1, neglectRadii);
+
+  static rai::Transformation Id(0);
+  if(coll) delete coll;
+  coll = new PairCollision(m1, m2, Id, Id, r1, r2);
+
+  if(!!J) {
+    arr Jp1, Jp2;
+    sweptPointJacobian(Jp1, coll->p1, coll->simplex1, m1, a0, a1, Ktuple);
+    sweptPointJacobian(Jp2, coll->p2, coll->simplex2, m2, b0, b1, Ktuple);
+    coll->kinDistance(y, J, Jp1, Jp2);
+    J *= -1.;
+    checkNan(J);
+  } else {
+    coll->kinDistance(y, NoArr, NoArr, NoArr);
+  }
+  y *= -1.;
+}
+
+rai::String TM_SweptPairCollision::shortTag(const rai::KinematicWorld &K) {
+  return STRING("SweptPairCollision-"<<K.frames(i)->name <<'-' <<K.frames(j)->name);
+}
+
+Graph TM_SweptPairCollision::getSpec(const rai::KinematicWorld& K){
+  return Graph({ {"feature", "sweptDist"}, {"o1", K.frames(i)->name}, {"o2", K.frames(j)->name}});
+}
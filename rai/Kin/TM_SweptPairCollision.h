@@ -0,0 +1,34 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2017 Marc Toussaint
+    email: marc.toussaint@informatik.uni-stuttgart.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include "feature.h"
+#include <Geo/mesh.h>
+
+/// (negative) distance between the swept volumes of two shapes between two consecutive slices:
+/// each shape's core mesh is taken at both poses and GJK/MPR operate on the convex hull of the union.
+/// This is conservative for translational motion and prevents tunneling through thin obstacles
+/// between coarse time slices. The Jacobian treats each witness point as the barycentric combination
+/// of its simplex vertices, each moving rigidly with the frame of the slice it stems from.
+struct TM_SweptPairCollision : Feature {
+  int i, j;               ///< which shapes does it refer to?
+  bool neglectRadii=false;
+  struct PairCollision *coll=0;
+  rai::Mesh m1, m2;       ///< swept core meshes (world coordinates) of the last evaluation
+
+  TM_SweptPairCollision(int _i, int _j, bool _neglectRadii=false);
+  TM_SweptPairCollision(const rai::KinematicWorld& K, const char* s1, const char* s2, bool _neglectRadii=false);
+  ~TM_SweptPairCollision();
+
+  virtual void phi(arr& y, arr& J, const rai::KinematicWorld& K){ NIY; }
+  virtual void phi(arr& y, arr& J, const WorldL& Ktuple);
+  virtual uint dim_phi(const rai::KinematicWorld& K) { return 1; }
+  virtual rai::String shortTag(const rai::KinematicWorld& K);
+  virtual Graph getSpec(const rai::KinematicWorld& K);
+};
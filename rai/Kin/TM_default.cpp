@@ -100,11 +100,11 @@ void TM_Default::phi(arr& y, arr& J, const rai::KinematicWorld& G) {
     CHECK(body_i,"");
     if(body_j==NULL) { //simple, no j reference
       G.kinematicsPos(y, J, body_i, vec_i);
-      y -= conv_vec2arr(vec_j);
+      y -= arr(&vec_j.x, 3); //by reference, no copy
     }else{
       rai::Vector pi = body_i->X * vec_i;
       rai::Vector pj = body_j->X * vec_j;
-      y = conv_vec2arr(body_j->X.rot / (pi-pj));
+      conv_vec2arr(y, body_j->X.rot / (pi-pj));
       if(!!J) {
         arr Ji, Jj, JRj;
         G.kinematicsPos(NoArr, Ji, body_i, vec_i);
@@ -131,9 +131,10 @@ void TM_Default::phi(arr& y, arr& J, const rai::KinematicWorld& G) {
     rai::Vector vec_j = jvec;
     G.kinematicsPos(y, J, body_i, vec_i);
     if(!body_j) { //relative to world
-      y -= conv_vec2arr(vec_j);
+      y -= arr(&vec_j.x, 3);
     }else{
-      arr y2, J2;
+      arr3 y2;
+      arr J2;
       G.kinematicsPos(y2, (!!J?J2:NoArr), body_j, vec_j);
       y -= y2;
       if(!!J) J -= J2;
@@ -166,11 +167,12 @@ void TM_Default::phi(arr& y, arr& J, const rai::KinematicWorld& G) {
     G.kinematicsVec(y, J, body_i, vec_i);
     if(!body_j) { //relative to world
       if(vec_i.isZero) RAI_MSG("attached vector is zero -- can't control that");
-      y -= conv_vec2arr(vec_j);
+      y -= arr(&vec_j.x, 3);
     } else {
       if(vec_i.isZero) RAI_MSG("attached vector1 is zero -- can't control that");
       if(vec_j.isZero) RAI_MSG("attached vector2 is zero -- can't control that");
-      arr y2, J2;
+      arr3 y2;
+      arr J2;
       G.kinematicsVec(y2, J2, body_j, vec_j);
       y -= y2;
       if(!!J) J -= J2;
@@ -183,10 +185,11 @@ void TM_Default::phi(arr& y, arr& J, const rai::KinematicWorld& G) {
     CHECK(fabs(jvec.length()-1.)<1e-4,"vector references must be normalized");
     rai::Vector vec_i = ivec;
     rai::Vector vec_j = jvec;
-    arr zi,Ji,zj,Jj;
+    arr3 zi, zj;
+    arr Ji, Jj;
     G.kinematicsVec(zi, Ji, body_i, vec_i);
     if(body_j==NULL) {
-      zj = conv_vec2arr(vec_j);
+      conv_vec2arr(zj, vec_j);
       if(!!J) { Jj.resizeAs(Ji); Jj.setZero(); }
     } else {
       G.kinematicsVec(zj, Jj, body_j, vec_j);
@@ -202,7 +205,8 @@ void TM_Default::phi(arr& y, arr& J, const rai::KinematicWorld& G) {
   
   if(type==pos1TMT_D) {
     CHECK(fabs(ivec.length()-1.)<1e-10,"vector references must be normalized");
-    arr orientation = conv_vec2arr(ivec);
+    arr3 orientation;
+    conv_vec2arr(orientation, ivec);
     G.kinematicsPos(y, NoArr, body_i);
     y = ~orientation*y;
     if(!!J) {
@@ -224,12 +228,13 @@ void TM_Default::phi(arr& y, arr& J, const rai::KinematicWorld& G) {
     
     rai::Vector vec_i = ivec;
     rai::Vector vec_j = jvec;
-    arr pi,Jpi, xi,Jxi, yi,Jyi, pj,Jpj;
+    arr3 pi, xi, yi, pj;
+    arr Jpi, Jxi, Jyi, Jpj;
     G.kinematicsPos(pi, Jpi, body_i, vec_i);
     G.kinematicsVec(xi, Jxi, body_i, Vector_x);
     G.kinematicsVec(yi, Jyi, body_i, Vector_y);
     if(body_j==NULL) { //we look at WORLD
-      pj = conv_vec2arr(vec_j);
+      conv_vec2arr(pj, vec_j);
       if(!!J) { Jpj.resizeAs(Jpi); Jpj.setZero(); }
     } else {
       G.kinematicsPos(pj, Jpj, body_j, vec_j);
@@ -249,12 +254,13 @@ void TM_Default::phi(arr& y, arr& J, const rai::KinematicWorld& G) {
     if(body_j==NULL) { //simple, no j reference
       G.kinematicsQuat(y, J, body_i);
     }else{
-      arr a,b,Ja,Jb;
+      arr4 a, b;
+      arr Ja, Jb;
       G.kinematicsQuat(b, Jb, body_i);
       G.kinematicsQuat(a, Ja, body_j);
 
       arr Jya, Jyb;
-      arr ainv = a;
+      arr4 ainv = a;
       if(a(0)!=1.) ainv(0) *= -1.;
       quat_concat(y, Jya, Jyb, ainv, b);
       if(a(0)!=1.) for(uint i=0;i<Jya.d0;i++) Jya(i,0) *= -1.;
@@ -273,7 +279,8 @@ void TM_Default::phi(arr& y, arr& J, const rai::KinematicWorld& G) {
       //diff to world, which is Id
       if(y(0)>=0.) y(0) -= 1.; else y(0) += 1.;
     } else {
-      arr y2, J2;
+      arr4 y2;
+      arr J2;
       G.kinematicsQuat(y2, J2, body_j);
       if(scalarProduct(y,y2)>=0.) {
         y -= y2;
@@ -287,7 +294,8 @@ void TM_Default::phi(arr& y, arr& J, const rai::KinematicWorld& G) {
   }
 
   if(type==TMT_pose) {
-    arr yq, Jq;
+    arr4 yq;
+    arr Jq;
     TM_Default tmp(*this);
     tmp.type = TMT_pos;
     tmp.phi(y, J, G);
@@ -299,7 +307,8 @@ void TM_Default::phi(arr& y, arr& J, const rai::KinematicWorld& G) {
   }
 
   if(type==TMT_poseDiff) {
-    arr yq, Jq;
+    arr4 yq;
+    arr Jq;
     TM_Default tmp(*this);
     tmp.type = TMT_posDiff;
     tmp.phi(y, J, G);
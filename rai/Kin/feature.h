@@ -30,6 +30,13 @@ public:
   void __phi(arr& y, arr& J, const WorldL& Ktuple){ phi(y,J,Ktuple); applyLinearTrans(y,J); }
   uint __dim_phi(const rai::KinematicWorld& K){ uint d=dim_phi(K); return applyLinearTrans_dim(d); }
   uint __dim_phi(const WorldL& Ktuple){ uint d=dim_phi(Ktuple); return applyLinearTrans_dim(d); }
+  
+  /// for assembly of many features into one buffer (KOMO): __phi_raw evaluates without the linear transformation;
+  /// __writeLinearTrans then writes the target-shifted, sign-flipped, and scaled y (times an extra s) directly into
+  /// yOut in a single pass, and calls Jrow(i, f) for each row i, whose transformed Jacobian is f*J[i].
+  /// Returns the output dimension. (Matrix scales fall back to applyLinearTrans on y and J, then f=s.)
+  void __phi_raw(arr& y, arr& J, const WorldL& Ktuple){ phi(y,J,Ktuple); }
+  template<class JRowWriter> uint __writeLinearTrans(double* yOut, arr& y, arr& J, double s, const JRowWriter& Jrow);
 
   Feature() : order(0), flipTargetSignOnNegScalarProduct(false) {}
   virtual ~Feature() {}
@@ -47,6 +54,34 @@ private:
   uint applyLinearTrans_dim(uint d);
 };
 
+template<class JRowWriter> uint Feature::__writeLinearTrans(double* yOut, arr& y, arr& J, double s, const JRowWriter& Jrow){
+  if(scale.nd==2 && scale.N>1){
+    applyLinearTrans(y, J);
+    for(uint i=0; i<y.N; i++) yOut[i] = s*y.p[i];
+    if(!!J) for(uint i=0; i<y.N; i++) Jrow(i, s);
+    return y.N;
+  }
+  const double *t = target.N ? target.p : NULL;
+  const double *c = scale.N ? scale.p : NULL;
+  if(t) CHECK_EQ(target.N, y.N, "");
+  if(c && scale.N>1) CHECK_EQ(scale.N, y.N, "");
+  const uint cStep = (scale.N>1 ? 1 : 0);
+  const bool flip = t && flipTargetSignOnNegScalarProduct;
+  double dot=0.;
+  for(uint i=0; i<y.N; i++) {
+    double si = c ? s*c[i*cStep] : s;
+    yOut[i] = si*(y.p[i] - (t?t[i]:0.));
+    if(flip) dot += y.p[i]*t[i];
+  }
+  double sign=1.;
+  if(flip && dot<-.0) {
+    sign=-1.;
+    for(uint i=0; i<y.N; i++) yOut[i] = (c ? s*c[i*cStep] : s)*(-y.p[i] - t[i]);
+  }
+  if(!!J) for(uint i=0; i<y.N; i++) Jrow(i, sign*(c ? s*c[i*cStep] : s));
+  return y.N;
+}
+
 //these are frequently used by implementations of task maps
 
 inline uintA getKtupleDim(const WorldL& Ktuple) {
@@ -69,12 +104,12 @@ inline void expandJacobian(arr& J, const WorldL& Ktuple, int i=-1) {
   arr tmp = zeros(J.d0, qdim.last());
 //  CHECK_EQ(J.d1, qdim.elem(i)-qdim.elem(i-1), "");
   tmp.setMatrixBlock(J, 0, qdim.elem(i-1));
-  J = tmp;
+  J = std::move(tmp);
 }
 
 inline void padJacobian(arr& J, const WorldL& Ktuple) {
   uintA qdim = getKtupleDim(Ktuple);
   arr tmp = zeros(J.d0, qdim.last());
   tmp.setMatrixBlock(J, 0, 0);
-  J = tmp;
+  J = std::move(tmp);
 }
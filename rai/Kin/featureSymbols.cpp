@@ -4,6 +4,7 @@
 #include <Kin/TM_proxy.h>
 #include <Kin/TM_qItself.h>
 #include <Kin/TM_PairCollision.h>
+#include <Kin/TM_SweptPairCollision.h>
 #include <Kin/TM_transition.h>
 #include <Kin/TM_qLimits.h>
 #include <Kin/TM_NewtonEuler.h>
@@ -45,6 +46,7 @@ template<> const char* rai::Enum<FeatureSymbol>::names []= {
   "energy",
   "transAccelerations",
   "transVelocities",
+  "sweptDistance",
   NULL
 };
 
@@ -62,6 +64,7 @@ double shapeSize(const rai::KinematicWorld& K, const char* name, uint i=2) {
 ptr<Feature> symbols2feature(FeatureSymbol feat, const StringA& frames, const rai::KinematicWorld& world, const arr& scale, const arr& target, int order){
   ptr<Feature> f;
   if(feat==FS_distance) {  f=make_shared<TM_PairCollision>(world, frames(0), frames(1), TM_PairCollision::_negScalar, false); }
+  else if(feat==FS_sweptDistance) {  f=make_shared<TM_SweptPairCollision>(world, frames(0), frames(1), false); }
   else if(feat==FS_aboveBox) {  f=make_shared<TM_AboveBox>(world, frames(1), frames(0), .05); }
   else if(feat==FS_standingAbove) {
     double h = .5*(shapeSize(world, frames(0)) + shapeSize(world, frames(1)));
@@ -50,6 +50,8 @@ enum FeatureSymbol {
 
   FS_transAccelerations,
   FS_transVelocities,
+
+  FS_sweptDistance,
 };
 
 namespace rai{
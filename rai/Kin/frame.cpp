@@ -157,7 +157,7 @@ void rai::Frame::read(const Graph& ats) {
   ats.get(X, "pose");
   ats.get(Q, "Q");
   
-  if(ats["type"]) ats["type"]->keys.last() = "shape"; //compatibility with old convention: 'body { type... }' generates shape
+  if(ats["type"]) { ats["type"]->keys.last() = "shape"; ats.invalidateKeyIndex(); } //compatibility with old convention: 'body { type... }' generates shape
   
   if(ats["joint"]) {
     if(ats["B"]){ //there is an extra transform from the joint into this frame -> create an own joint frame
@@ -1111,6 +1111,7 @@ void rai::Shape::createMeshes() {
         CHECK(mesh().V.N, "mesh or sscCore needs to be loaded");
         sscCore() = mesh();
       }
+      sscCore().makeConvexHull(); //same swept volume, fewer spheres; reused from Mesh/cacheDir
       mesh().setSSCvx(sscCore(), size.last());
       break;
     case rai::ST_ssBox: {
@@ -35,6 +35,7 @@
 #include <GeoOptim/geoOptim.h>
 #include <Gui/opengl.h>
 #include <Algo/algos.h>
+#include <Core/profile.h>
 #include <iomanip>
 
 #ifndef RAI_ORS_ONLY_BASICS
@@ -138,6 +139,7 @@ namespace rai {
     OpenGL *gl;
     std::shared_ptr<SwiftInterface> swift;
     ptr<FclInterface> fcl;
+    intA fclTopology; ///< what the fcl pair filter was computed from (see updateCollisionTopology)
     PhysXInterface *physx;
     OdeInterface *ode;
     FeatherstoneInterface *fs = NULL;
@@ -172,6 +174,7 @@ rai::KinematicWorld::~KinematicWorld() {
 }
 
 void rai::KinematicWorld::init(const char* filename) {
+  if(rai::String(filename).endsWith(".kin")) { readSnapshot(filename); return; }
   rai::FileToken file(filename, true);
   Graph G(file);
   G.checkConsistency();
@@ -851,7 +854,7 @@ void rai::KinematicWorld::kinematicsPos(arr& y, arr& J, Frame *a, const rai::Vec
   //get position
   rai::Vector pos_world = a->X.pos;
   if(!!rel && !rel.isZero) pos_world += a->X.rot*rel;
-  if(!!y) y = conv_vec2arr(pos_world); //return the output
+  if(!!y) conv_vec2arr(y, pos_world); //return the output
   if(!J) return; //do not return the Jacobian
   
   jacobianPos(J, a, pos_world);
@@ -883,12 +886,14 @@ void rai::KinematicWorld::jacobianPos(arr& J, Frame *a, const rai::Vector& pos_w
           J(2, j_idx) += j->scale * j->axis.z;
         } else if(j->type==JT_transXY) {
           if(j->mimic) NIY;
-          arr R = j->X().rot.getArr();
+          arr33 R;
+          j->X().rot.getMatrix(R.p);
           R *= j->scale;
           J.setMatrixBlock(R.sub(0,-1,0,1), 0, j_idx);
         } else if(j->type==JT_transXYPhi) {
           if(j->mimic) NIY;
-          arr R = j->X().rot.getArr();
+          arr33 R;
+          j->X().rot.getMatrix(R.p);
           R *= j->scale;
           J.setMatrixBlock(R.sub(0,-1,0,1), 0, j_idx);
           rai::Vector tmp = j->axis ^ (pos_world-(j->X().pos + j->X().rot*a->Q.pos));
@@ -903,20 +908,23 @@ void rai::KinematicWorld::jacobianPos(arr& J, Frame *a, const rai::Vector& pos_w
           J(0, j_idx) += tmp.x;
           J(1, j_idx) += tmp.y;
           J(2, j_idx) += tmp.z;
-          arr R = (j->X().rot*a->Q.rot).getArr();
+          arr33 R;
+          (j->X().rot*a->Q.rot).getMatrix(R.p);
           R *= j->scale;
           J.setMatrixBlock(R.sub(0,-1,0,1), 0, j_idx+1);
         }
         if(j->type==JT_XBall) {
           if(j->mimic) NIY;
-          arr R = conv_vec2arr(j->X().rot.getX());
+          arr3 R;
+          conv_vec2arr(R, j->X().rot.getX());
           R *= j->scale;
           R.reshape(3,1);
           J.setMatrixBlock(R, 0, j_idx);
         }
         if(j->type==JT_trans3 || j->type==JT_free) {
           if(j->mimic) NIY;
-          arr R = j->X().rot.getArr();
+          arr33 R;
+          j->X().rot.getMatrix(R.p);
           R *= j->scale;
           J.setMatrixBlock(R, 0, j_idx);
         }
@@ -1005,7 +1013,7 @@ void rai::KinematicWorld::kinematicsPos_wrtFrame(arr& y, arr& J, Frame *b, const
   //get position
   rai::Vector pos_world = b->X.pos;
   if(!!rel) pos_world += b->X.rot*rel;
-  if(!!y) y = conv_vec2arr(pos_world); //return the output
+  if(!!y) conv_vec2arr(y, pos_world); //return the output
   if(!J) return; //do not return the Jacobian
   
   //get Jacobian
@@ -1105,7 +1113,7 @@ void rai::KinematicWorld::kinematicsVec(arr& y, arr& J, Frame *a, const rai::Vec
   rai::Vector vec_world;
   if(!!vec) vec_world = a->X.rot*vec;
   else     vec_world = a->X.rot.getZ();
-  if(!!y) y = conv_vec2arr(vec_world); //return the vec
+  if(!!y) conv_vec2arr(y, vec_world); //return the vec
   if(!!J) {
     arr A;
     axesMatrix(A, a);
@@ -1119,7 +1127,7 @@ void rai::KinematicWorld::kinematicsVec(arr& y, arr& J, Frame *a, const rai::Vec
 void rai::KinematicWorld::kinematicsQuat(arr& y, arr& J, Frame *a) const { //TODO: allow for relative quat
   CHECK_EQ(&a->K, this, "");
   rai::Quaternion rot_a = a->X.rot;
-  if(!!y) y = conv_quat2arr(rot_a); //return the vec
+  if(!!y) conv_quat2arr(y, rot_a); //return the vec
   if(!!J) {
     arr A;
     axesMatrix(A, a);
@@ -1192,25 +1200,32 @@ void rai::KinematicWorld::axesMatrix(arr& J, Frame *a) const {
 
 /// The position vec1, attached to b1, relative to the frame of b2 (plus vec2)
 void rai::KinematicWorld::kinematicsRelPos(arr& y, arr& J, Frame *a, const rai::Vector& vec1, Frame *b, const rai::Vector& vec2) const {
-  arr y1,y2,J1,J2;
+  arr3 y1, y2;
+  arr J1, J2;
   kinematicsPos(y1, J1, a, vec1);
   kinematicsPos(y2, J2, b, vec2);
-  arr Rinv = ~(b->X.rot.getArr());
-  y = Rinv * (y1 - y2);
+  arr33 Rinv;
+  rai::Quaternion rot_inv = b->X.rot;
+  rot_inv.invert().getMatrix(Rinv.p);
+  y1 -= y2;
+  innerProduct(y, Rinv, y1);
   if(!!J) {
     arr A;
     axesMatrix(A, b);
-    J = Rinv * (J1 - J2 - crossProduct(A, y1 - y2));
+    J = Rinv * (J1 - J2 - crossProduct(A, y1));
   }
 }
 
 /// The vector vec1, attached to b1, relative to the frame of b2
 void rai::KinematicWorld::kinematicsRelVec(arr& y, arr& J, Frame *a, const rai::Vector& vec1, Frame *b) const {
-  arr y1,J1;
+  arr3 y1;
+  arr J1;
   kinematicsVec(y1, J1, a, vec1);
   //  kinematicsVec(y2, J2, b2, vec2);
-  arr Rinv = ~(b->X.rot.getArr());
-  y = Rinv * y1;
+  arr33 Rinv;
+  rai::Quaternion rot_inv = b->X.rot;
+  rot_inv.invert().getMatrix(Rinv.p);
+  innerProduct(y, Rinv, y1);
   if(!!J) {
     arr A;
     axesMatrix(A, b);
@@ -1221,7 +1236,7 @@ void rai::KinematicWorld::kinematicsRelVec(arr& y, arr& J, Frame *a, const rai::
 /// The position vec1, attached to b1, relative to the frame of b2 (plus vec2)
 void rai::KinematicWorld::kinematicsRelRot(arr& y, arr& J, Frame *a, Frame *b) const {
   rai::Quaternion rot_b = a->X.rot;
-  if(!!y) y = conv_vec2arr(rot_b.getVec());
+  if(!!y) conv_vec2arr(y, rot_b.getVec());
   if(!!J) {
     double phi=acos(rot_b.w);
     double s=2.*phi/sin(phi);
@@ -1475,7 +1490,40 @@ SwiftInterface& rai::KinematicWorld::swift() {
   return *s->swift;
 }
 
+/// what canCollideWith depends on: per frame its parent, whether it has a joint, and its contact flag;
+/// refills T in place and returns whether it changed ('objectsChanged' if the set of contact shapes did)
+static bool updateCollisionTopology(intA& T, const FrameL& frames, bool& objectsChanged) {
+  bool changed = objectsChanged = (T.d0!=frames.N);
+  if(changed) T.resize(frames.N, 3).setZero();
+  for(rai::Frame *f:frames) {
+    int *t = T.p+3*f->ID;
+    int parent = f->parent ? f->parent->ID : -1, joint = f->joint ? 1 : 0, cont = f->shape ? f->shape->cont : 0;
+    if(t[0]==parent && t[1]==joint && t[2]==cont) continue;
+    changed = true;
+    if(!t[2]!=!cont) objectsChanged = true;
+    t[0]=parent;  t[1]=joint;  t[2]=cont;
+  }
+  return changed;
+}
+
+/// precompute the broadphase pair filter, instead of evaluating canCollideWith per returned pair
+static void setCollisionFilter(rai::SweepAndPrune& bp, const FrameL& frames) {
+  bp.filter.setZero();
+  for(rai::Frame *a:frames) if(a->shape && a->shape->cont) {
+    for(rai::Frame *b:frames) if(b->ID<a->ID && b->shape && b->shape->cont) {
+      bp.allowPair(a->ID, b->ID, a->shape->canCollideWith(b));
+    }
+  }
+}
+
 rai::FclInterface& rai::KinematicWorld::fcl(){
+  //the filter is stale after changes of the frame tree or contact flags: refill it, or rebuild
+  //all collision objects if the set of contact shapes changed
+  bool objectsChanged;
+  if(updateCollisionTopology(s->fclTopology, frames, objectsChanged) && s->fcl){
+    if(objectsChanged) s->fcl.reset();
+    else setCollisionFilter(s->fcl->broadphase, frames);
+  }
   if(!s->fcl){
     Array<ptr<Mesh>> geometries(frames.N);
     for(Frame *f:frames){
@@ -1485,6 +1533,7 @@ rai::FclInterface& rai::KinematicWorld::fcl(){
       }
     }
     s->fcl = make_shared<rai::FclInterface>(geometries, .0);
+    setCollisionFilter(s->fcl->broadphase, frames);
   }
   return *s->fcl;
 }
@@ -1565,39 +1614,38 @@ void rai::KinematicWorld::glGetMasks(int w, int h, bool rgbIndices) {
 
 void rai::KinematicWorld::stepSwift() {
   swift().step(*this, false);
+  rai::profileCount("collision/broadphase");
+  rai::profileCount("collision/pairs", proxies.N);
   //  reportProxies();
   //  watch(true);
   //  gl().closeWindow();
 }
 
 void rai::KinematicWorld::stepFcl(){
-  arr X(frames.N, 7);
-  X.setZero();
+  FclInterface& F = fcl();
+  double X7[7];
   for(Frame *f:frames){
-    if(f->shape && f->shape->cont) X[f->ID] = f->X.getArr7d();
-  }
-  fcl().step(X);
-  uintA& COL = fcl().collisions;
-  boolA filter(COL.d0);
-  uint n=0;
-  for(uint i=0;i<COL.d0;i++){
-    bool canCollide = frames(COL(i,0))->shape->canCollideWith(frames(COL(i,1)));
-    filter(i) = canCollide;
-    if(canCollide) n++;
-  }
-  proxies.clear();
-  proxies.resize(n);
-  for(uint i=0,j=0;i<COL.d0;i++){
-    if(filter(i)){
-      Proxy& p = proxies(j);
-      p.a = frames(COL(i,0));
-      p.b = frames(COL(i,1));
-      p.d = -0.;
-      p.posA = frames(COL(i,0))->shape->mesh().getCenter();
-      p.posB = frames(COL(i,1))->shape->mesh().getCenter();
-      j++;
+    if(f->ID<F.objects.size() && F.objects[f->ID]){
+      const Transformation& X = f->X;
+      X7[0]=X.pos.x;  X7[1]=X.pos.y;  X7[2]=X.pos.z;
+      X7[3]=X.rot.w;  X7[4]=X.rot.x;  X7[5]=X.rot.y;  X7[6]=X.rot.z;
+      F.setPose(f->ID, X7);
     }
   }
+  F.step();
+  const uintA& COL = F.collisions;
+  proxies.clear();
+  proxies.resize(COL.d0);
+  for(uint i=0;i<COL.d0;i++){
+    Proxy& p = proxies(i);
+    p.a = frames(COL(i,0));
+    p.b = frames(COL(i,1));
+    p.d = -0.;
+    p.posA = p.a->shape->mesh().getCenter();
+    p.posB = p.b->shape->mesh().getCenter();
+  }
+  rai::profileCount("collision/broadphase");
+  rai::profileCount("collision/pairs", proxies.N);
 }
 
 void rai::KinematicWorld::stepPhysx(double tau) {
@@ -258,6 +258,8 @@ struct KinematicWorld : GLDrawer {
   void writeURDF(std::ostream& os, const char *robotName="myrobot") const;
   void writeMeshes(const char* pathPrefix="meshes/") const;
   void read(std::istream& is);
+  void writeSnapshot(const char* filename) const; ///< versioned binary snapshot of frames, joints, shapes, inertias, q, and proxies
+  void readSnapshot(const char* filename);        ///< also used by init() for '.kin' files
   void glDraw(struct OpenGL&);
   void glDraw_sub(struct OpenGL&);
   Graph getGraph() const;
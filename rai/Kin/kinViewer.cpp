@@ -96,32 +96,94 @@ void KinViewer::step() {
 
 //===========================================================================
 
+/// true if both worlds have the same frames (by name) and shape geometries, so that poses of one can be displayed with the other
+static bool sameFrameStructure(const rai::KinematicWorld& A, const rai::KinematicWorld& B) {
+  if(A.frames.N!=B.frames.N) return false;
+  for(uint i=0; i<A.frames.N; i++) {
+    rai::Frame *a=A.frames.elem(i), *b=B.frames.elem(i);
+    if(a->name!=b->name || !a->shape!=!b->shape) return false;
+    if(a->shape) {
+      rai::Shape *sa=a->shape, *sb=b->shape;
+      if(sa->_type!=sb->_type || sa->visual!=sb->visual || sa->_mesh!=sb->_mesh) return false; //copies share the mesh
+      if(sa->size.N!=sb->size.N || (sa->size.N && maxDiff(sa->size, sb->size)!=0.)) return false;
+    }
+  }
+  return true;
+}
+
+/// sets the frame poses of K from the (frames x T x 7) tensor X at time t
+static void setFramePoses(rai::KinematicWorld& K, const arr& X, uint t) {
+  uint n=X.d0;
+  if(K.frames.N<n) n=K.frames.N;
+  for(uint i=0; i<n; i++) {
+    const double *x = X.p + (i*X.d1+t)*7;
+    rai::Frame *f=K.frames.elem(i);
+    f->X.pos.set(x);
+    f->X.rot.set(x+3);
+  }
+}
+
+void KinPathViewer::setPath(const rai::KinematicWorld& model, const arr& _frameState) {
+  CHECK(!_frameState.N || (_frameState.nd==3 && _frameState.d2==7), "need a (frames x T x 7) pose tensor");
+  auto mux = stepMutex(RAI_HERE); //the model and the poses change together for step()
+  listDelete(models);
+  if(!sameFrameStructure(copy, model)) {
+    if(gl) gl->dataLock.lock(RAI_HERE);
+    copy.copy(model, true);
+    copy.proxies.clear();
+    if(gl) gl->dataLock.unlock();
+  }
+  frameState.set() = _frameState;
+}
+
 void KinPathViewer::setConfigurations(const WorldL& cs) {
-  configurations.writeAccess();
-  listResize(configurations(), cs.N);
-  for(uint i=0; i<cs.N; i++) configurations()(i)->copy(*cs(i), true);
-  configurations.deAccess();
+  if(!cs.N) { clear(); return; }
+  uint n=0;
+  bool sameStructure=true;
+  for(rai::KinematicWorld *K:cs) {
+    if(K->frames.N>n) n=K->frames.N;
+    if(K!=cs.first() && !sameFrameStructure(*K, *cs.first())) sameStructure=false;
+  }
+  arr X = zeros(n, cs.N, 7);
+  for(uint t=0; t<cs.N; t++) {
+    for(uint i=0; i<cs(t)->frames.N; i++) {
+      const rai::Transformation& f = cs(t)->frames.elem(i)->X;
+      double *x = &X(i, t, 0);
+      x[0]=f.pos.x; x[1]=f.pos.y; x[2]=f.pos.z;
+      x[3]=f.rot.w; x[4]=f.rot.x; x[5]=f.rot.y; x[6]=f.rot.z;
+    }
+  }
+  if(sameStructure) { setPath(*cs.first(), X); return; }
+
+  //slices differ (e.g. by switches): step() switches the displayed model per slice
+  auto mux = stepMutex(RAI_HERE);
+  listResize(models, cs.N);
+  for(uint t=0; t<cs.N; t++) models(t)->copy(*cs(t), true);
+  frameState.set() = X;
 }
 
 void KinPathViewer::clear() {
-  listDelete(configurations.set()());
+  auto mux = stepMutex(RAI_HERE);
+  listDelete(models);
+  frameState.set()->clear();
   text.clear();
 }
 
-KinPathViewer::KinPathViewer(const Var<WorldL>& _configurations, double beatIntervalSec, int tprefix)
-  : Thread(STRING("KinPathViewer_"<<_configurations.name()), beatIntervalSec),
-    configurations(this, _configurations, (beatIntervalSec<0.)),
-    t(0), tprefix(tprefix), writeToFiles(false) {
+KinPathViewer::KinPathViewer(const Var<arr>& _frameState, double beatIntervalSec, int tprefix)
+  : Thread(STRING("KinPathViewer_"<<_frameState.name()), beatIntervalSec),
+    frameState(this, _frameState, (beatIntervalSec<0.)),
+    gl(NULL), t(0), tprefix(tprefix), writeToFiles(false) {
   if(beatIntervalSec>=0.) threadLoop(); else threadStep();
 }
 
 KinPathViewer::~KinPathViewer() {
   threadClose();
-  clear();
+  listDelete(models);
+  frameState.set()->clear();
 }
 
 void KinPathViewer::open() {
-  gl = new OpenGL(STRING("KinPathViewer: "<<configurations.name()));
+  gl = new OpenGL(STRING("KinPathViewer: "<<frameState.name()));
   gl->add(glStandardScene);
   gl->add(copy);
   gl->camera.setDefault();
@@ -129,20 +191,23 @@ void KinPathViewer::open() {
 
 void KinPathViewer::close() {
   delete gl;
+  gl=NULL;
 }
 
 void KinPathViewer::step() {
   uint T,tt;
   {
     auto _dataLock = gl->dataLock(RAI_HERE);
-    configurations.readAccess();
-    T=configurations().N;
+    auto X = frameState.get();
+    T = X->N ? X->d1 : 0;
     if(t>=T*1.1) t=0;
     tt=t;
     if(tt>=T) tt=T-1;
-    if(T) copy.copy(*configurations()(tt), true);
-    configurations.deAccess();
-    copy.checkConsistency();
+    if(T && models.N && !sameFrameStructure(copy, *models(tt))) {
+      copy.copy(*models(tt), true);
+      copy.proxies.clear();
+    }
+    if(T) setFramePoses(copy, X, tt);
   }
   if(T) {
     copy.orsDrawMarkers=false;
@@ -169,7 +234,8 @@ void renderConfigurations(const WorldL& cs, const char* filePrefix, int tprefix,
     gl.camera.focus(.5, 0., .7);
   }
   for(uint t=0; t<cs.N; t++) {
-    copy.copy(*cs(t), true);
+    if(!sameFrameStructure(copy, *cs(t))) copy.copy(*cs(t), true); //otherwise only the poses change
+    for(uint i=0; i<copy.frames.N; i++) copy.frames.elem(i)->X = cs(t)->frames.elem(i)->X;
     gl.update(STRING(" (time " <<tprefix+int(t) <<'/' <<tprefix+int(cs.N) <<')').p, true);
     write_ppm(gl.captureImage, STRING(filePrefix<<std::setw(4)<<std::setfill('0')<<t<<".ppm"));
   }
@@ -35,20 +35,24 @@ struct KinViewer : Thread {
 
 //===========================================================================
 
+/// displays a path as one model plus a (frames x T x 7) pose tensor (e.g. from KOMO::getPath_frames);
+/// the model is only recopied when its frame structure changes, each displayed step only sets frame poses
 struct KinPathViewer : Thread {
-  Var<WorldL> configurations;
+  Var<arr> frameState; ///< poses to be displayed
   //-- internal (private)
   rai::KinematicWorld copy;
+  WorldL models; ///< per-slice models, only if the slices of setConfigurations differ in structure
   struct OpenGL *gl;
   uint t;
   int tprefix;
   bool writeToFiles;
   rai::String text;
   
-  void setConfigurations(const WorldL& cs);
+  void setPath(const rai::KinematicWorld& model, const arr& _frameState);
+  void setConfigurations(const WorldL& cs); ///< model from cs(0) (per slice if their frames differ), poses of all frames of all cs
   void clear();
   
-  KinPathViewer(const Var<WorldL>& _configurations, double beatIntervalSec=.2, int tprefix=0);
+  KinPathViewer(const Var<arr>& _frameState, double beatIntervalSec=.2, int tprefix=0);
   ~KinPathViewer();
   void open();
   void step();
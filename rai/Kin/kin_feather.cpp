@@ -229,9 +229,9 @@ void Featherstone::skew(arr& X, const double *v) {
 arr Featherstone::skew(const double *v) { arr X; skew(X, v); return X; }
 
 void FrameToMatrix(arr &X, const rai::Transformation& f) {
-  arr z(3, 3);  z.setZero();
-  arr r(3, 3);  Featherstone::skew(r, &f.pos.x);
-  arr R(3, 3);  f.rot.getMatrix(R.p);
+  arr33 z;
+  arr33 r;  Featherstone::skew(r, &f.pos.x);
+  arr33 R;  f.rot.getMatrix(R.p);
   transpose(R);
   X.resize(6, 6);  X.setBlockMatrix(R, z, R*~r, R); //[[unklar!!]]
   //cout <<"\nz=" <<z <<"\nr=" <<r <<"\nR=" <<R <<"\nX=" <<X <<endl;
@@ -432,7 +432,7 @@ void Featherstone::RBmci(arr& rbi, double m, double *c, const rai::Matrix& I) {
   % RBmci(m, c, I) calculate MF6 rigid-body inertia tensor for a body with
   % mass m, centre of mass at c, and (3x3) rotational inertia about CoM of I.
   */
-  arr C(3, 3);
+  arr33 C;
   skew(C, c);
   //C = [ 0, -c(3), c(2); c(3), 0, -c(1); -c(2), c(1), 0 ];
   arr II;
@@ -23,7 +23,8 @@ struct F_Link {
   rai::Matrix inertia=0;
   uint dof();
   
-  arr _h, _Q, _I, _f; //featherstone types
+  arr6 _h, _f; //featherstone types (inline storage)
+  arr66 _Q, _I;
   
   F_Link() {}
   void setFeatherstones();
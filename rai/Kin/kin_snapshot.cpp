@@ -0,0 +1,296 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2017 Marc Toussaint
+    email: marc.toussaint@informatik.uni-stuttgart.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "kin.h"
+#include "frame.h"
+#include "proxy.h"
+#include "uncertainty.h"
+
+#include <map>
+#include <fstream>
+
+/* Binary snapshot of a KinematicWorld: all frames with their relative and absolute poses,
+   attributes, joints, shapes, inertias, plus the state q, qdot and the proxies. Meshes are
+   stored once per shared mesh instance (shapes that share a mesh also share it after loading).
+
+   The file is a sequence of little-endian records; only mesh payloads are aligned (to 8 bytes). It is
+   mapped (Geo/mesh.h MappedFile): records are decoded with memcpy, the mesh arrays live in the mapping
+   (copy-on-write, until they grow). Frame attributes (ats) are stored node by node for the types the .g
+   parser creates; graphs that contain anything else (e.g. parent links) fall back to text. */
+
+//===========================================================================
+
+namespace {
+
+const char snapshotMagic[8] = {'R','A','I','K','I','N','S','1'};
+const uint32_t snapshotVersion = 2; //1: unaligned mesh payloads (copied when read)
+
+enum AtsType : uint8_t { AT_bool=0, AT_double, AT_int, AT_String, AT_FileToken, AT_StringA, AT_arr, AT_Graph };
+
+struct Writer {
+  std::ostream& os;
+  Writer(std::ostream& os) : os(os) {}
+  template<class T> void pod(const T& x) { os.write((const char*)&x, sizeof(T)); }
+  void str(const rai::String& s) { pod<uint32_t>(s.N); os.write(s.p, s.N); }
+  void strA(const StringA& S) { pod<uint32_t>(S.N); for(const rai::String& s:S) str(s); }
+  template<class T> void array(const rai::Array<T>& x, bool aligned=false) {
+    CHECK_LE(x.nd, 3, "");
+    pod<uint32_t>(x.nd);  pod<uint32_t>(x.d0);  pod<uint32_t>(x.d1);  pod<uint32_t>(x.d2);
+    if(aligned) { char zeros[8] = {0}; os.write(zeros, (8-os.tellp()%8)%8); }
+    os.write((const char*)x.p, x.N*sizeof(T));
+  }
+  void vec(const rai::Vector& v) { pod(v.x); pod(v.y); pod(v.z); pod<uint8_t>(v.isZero); }
+  void quat(const rai::Quaternion& q) { pod(q.w); pod(q.x); pod(q.y); pod(q.z); pod<uint8_t>(q.isZero); }
+  void trans(const rai::Transformation& X) { vec(X.pos); quat(X.rot); }
+};
+
+struct Reader {
+  char *begin, *p, *end;
+  Reader(char* p, size_t n) : begin(p), p(p), end(p+n) {}
+  void bytes(void* x, size_t n) {
+    CHECK_LE(p+n, end, "truncated snapshot");
+    memcpy(x, p, n);
+    p += n;
+  }
+  template<class T> T pod() { T x; bytes(&x, sizeof(T)); return x; }
+  void str(rai::String& s) { uint32_t n=pod<uint32_t>(); s.resize(n, false); bytes(s.p, n); }
+  void strA(StringA& S) { S.resize(pod<uint32_t>()); for(rai::String& s:S) str(s); }
+  template<class T> void array(rai::Array<T>& x) {
+    uint32_t nd=pod<uint32_t>(), d0=pod<uint32_t>(), d1=pod<uint32_t>(), d2=pod<uint32_t>();
+    if(nd==0) x.clear();
+    if(nd==1) x.resize(d0);
+    if(nd==2) x.resize(d0, d1);
+    if(nd==3) x.resize(d0, d1, d2);
+    bytes(x.p, x.N*sizeof(T));
+  }
+  /// lets the (empty) x live in the aligned payload in the mapped file
+  template<class T> void mappedArray(rai::Array<T>& x) {
+    uint32_t nd=pod<uint32_t>(), d0=pod<uint32_t>(), d1=pod<uint32_t>(), d2=pod<uint32_t>();
+    CHECK_LE(nd, 3, "corrupt snapshot");
+    uint64_t N = (nd==0 ? 0 : nd==1 ? d0 : nd==2 ? uint64_t(d0)*d1 : uint64_t(d0)*d1*d2);
+    p += (8-(p-begin)%8)%8;
+    CHECK_LE(p+N*sizeof(T), end, "truncated snapshot");
+    x.setLocalMEM((T*)p, N, N);
+    if(nd==2) x.reshape(d0, d1);
+    if(nd==3) x.reshape(d0, d1, d2);
+    p += N*sizeof(T);
+  }
+  void vec(rai::Vector& v) { v.x=pod<double>(); v.y=pod<double>(); v.z=pod<double>(); v.isZero=pod<uint8_t>(); }
+  void quat(rai::Quaternion& q) { q.w=pod<double>(); q.x=pod<double>(); q.y=pod<double>(); q.z=pod<double>(); q.isZero=pod<uint8_t>(); }
+  void trans(rai::Transformation& X) { vec(X.pos); quat(X.rot); }
+};
+
+bool isBinaryEncodable(const Graph& G) {
+  for(Node *n:G) {
+    if(n->parents.N) return false;
+    if(n->isOfType<bool>() || n->isOfType<double>() || n->isOfType<int>() || n->isOfType<rai::String>()
+        || n->isOfType<rai::FileToken>() || n->isOfType<StringA>() || n->isOfType<arr>()) continue;
+    if(n->isGraph() && isBinaryEncodable(n->graph())) continue;
+    return false;
+  }
+  return true;
+}
+
+void writeAts(Writer& W, const Graph& G) {
+  W.pod<uint32_t>(G.N);
+  for(Node *n:G) {
+    W.strA(n->keys);
+    if(n->isOfType<bool>()) { W.pod<uint8_t>(AT_bool); W.pod<uint8_t>(n->get<bool>()); }
+    else if(n->isOfType<double>()) { W.pod<uint8_t>(AT_double); W.pod(n->get<double>()); }
+    else if(n->isOfType<int>()) { W.pod<uint8_t>(AT_int); W.pod<int32_t>(n->get<int>()); }
+    else if(n->isOfType<rai::String>()) { W.pod<uint8_t>(AT_String); W.str(n->get<rai::String>()); }
+    else if(n->isOfType<rai::FileToken>()) {
+      const rai::FileToken& f = n->get<rai::FileToken>();
+      W.pod<uint8_t>(AT_FileToken); W.str(f.name); W.str(f.path); W.str(f.cwd);
+    }
+    else if(n->isOfType<StringA>()) { W.pod<uint8_t>(AT_StringA); W.strA(n->get<StringA>()); }
+    else if(n->isOfType<arr>()) { W.pod<uint8_t>(AT_arr); W.array(n->get<arr>()); }
+    else if(n->isGraph()) { W.pod<uint8_t>(AT_Graph); writeAts(W, n->graph()); }
+    else HALT("can't encode node '" <<*n <<"'");
+  }
+}
+
+void readAts(Reader& R, Graph& G) {
+  uint32_t N = R.pod<uint32_t>();
+  StringA keys;
+  for(uint i=0; i<N; i++) {
+    R.strA(keys);
+    switch(R.pod<uint8_t>()) {
+      case AT_bool: G.newNode<bool>(keys, {}, R.pod<uint8_t>()); break;
+      case AT_double: G.newNode<double>(keys, {}, R.pod<double>()); break;
+      case AT_int: G.newNode<int>(keys, {}, R.pod<int32_t>()); break;
+      case AT_String: { rai::String s; R.str(s); G.newNode<rai::String>(keys, {}, s); } break;
+      case AT_FileToken: {
+        rai::FileToken f;
+        R.str(f.name); R.str(f.path); R.str(f.cwd);
+        G.newNode<rai::FileToken>(keys, {}, f);
+      } break;
+      case AT_StringA: { StringA S; R.strA(S); G.newNode<StringA>(keys, {}, S); } break;
+      case AT_arr: { arr x; R.array(x); G.newNode<arr>(keys, {}, x); } break;
+      case AT_Graph: readAts(R, G.newSubgraph(keys, {})); break;
+      default: HALT("corrupt snapshot: unknown attribute type");
+    }
+  }
+}
+
+void writeMesh(Writer& W, const rai::Mesh& M) {
+  W.array(M.V, true);  W.array(M.Vn, true);  W.array(M.C, true);  W.array(M.T, true);  W.array(M.Tn, true);
+  W.array(M.Tt, true);  W.array(M.tex, true);  W.array(M.texImg, true);
+}
+
+void readMesh(Reader& R, rai::Mesh& M, const std::shared_ptr<rai::MappedFile>& file, uint32_t version) {
+  if(version==1) {
+    R.array(M.V);  R.array(M.Vn);  R.array(M.C);  R.array(M.T);  R.array(M.Tn);
+    R.array(M.Tt);  R.array(M.tex);  R.array(M.texImg);
+    return;
+  }
+  M.mapping.file = file;
+  R.mappedArray(M.V);  R.mappedArray(M.Vn);  R.mappedArray(M.C);  R.mappedArray(M.T);  R.mappedArray(M.Tn);
+  R.mappedArray(M.Tt);  R.mappedArray(M.tex);  R.mappedArray(M.texImg);
+}
+
+}
+
+//===========================================================================
+
+void rai::KinematicWorld::writeSnapshot(const char* filename) const {
+  std::ofstream os(filename, std::ios::binary);
+  CHECK(os.good(), "could not open '" <<filename <<"' for writing");
+  Writer W(os);
+  os.write(snapshotMagic, 8);
+  W.pod<uint32_t>(snapshotVersion);
+
+  //-- meshes, once per instance
+  std::map<const Mesh*, int32_t> meshIndex;
+  rai::Array<const Mesh*> meshes;
+  for(Frame *f:frames) if(f->shape) for(const ptr<Mesh>& m: {f->shape->_mesh, f->shape->_sscCore}) {
+    if(m && meshIndex.find(m.get())==meshIndex.end()) { meshIndex[m.get()]=meshes.N; meshes.append(m.get()); }
+  }
+  W.pod<uint32_t>(meshes.N);
+  for(const Mesh *m:meshes) writeMesh(W, *m);
+
+  //-- frames
+  W.pod<uint32_t>(frames.N);
+  for(Frame *f:frames) {
+    W.str(f->name);
+    W.pod<int32_t>(f->parent ? f->parent->ID : -1);
+    W.trans(f->Q);  W.trans(f->X);
+    W.pod(f->tau);
+    W.pod<uint8_t>(f->active);
+    W.pod<int32_t>(f->flags);
+    if(isBinaryEncodable(f->ats)) { W.pod<uint8_t>(0); writeAts(W, f->ats); }
+    else { W.pod<uint8_t>(1); rai::String txt; f->ats.write(txt, "\n", NULL); W.str(txt); }
+    W.pod<uint8_t>((f->joint?1:0) | (f->shape?2:0) | (f->inertia?4:0));
+
+    if(Joint *j=f->joint) {
+      W.pod<uint32_t>(j->dim);  W.pod<uint32_t>(j->qIndex);  W.pod(j->generator);
+      W.array(j->limits);  W.array(j->q0);
+      W.pod(j->H);  W.pod(j->scale);
+      W.pod<int32_t>(j->mimic ? j->mimic->frame->ID : -1);
+      W.vec(j->axis);
+      W.pod<int32_t>(j->type);
+      W.pod<uint8_t>(j->constrainToZeroVel);  W.pod<uint8_t>(j->active);
+      W.pod<uint8_t>(j->uncertainty!=NULL);
+      if(j->uncertainty) W.array(j->uncertainty->sigma);
+    }
+    if(Shape *s=f->shape) {
+      W.pod<int32_t>(s->_type);
+      W.array(s->size);
+      W.pod(s->cont);  W.pod<uint8_t>(s->visual);
+      W.pod<int32_t>(s->_mesh ? meshIndex[s->_mesh.get()] : -1);
+      W.pod<int32_t>(s->_sscCore ? meshIndex[s->_sscCore.get()] : -1);
+    }
+    if(Inertia *i=f->inertia) {
+      W.pod(i->mass);  W.pod(i->matrix);  W.pod<int32_t>(i->type);
+      W.vec(i->com);  W.vec(i->force);  W.vec(i->torque);
+    }
+  }
+
+  //-- state and proxies
+  W.array(q);  W.array(qdot);
+  W.pod<uint32_t>(proxies.N);
+  for(const Proxy& p:proxies) {
+    W.pod<int32_t>(p.a->ID);  W.pod<int32_t>(p.b->ID);
+    W.vec(p.posA);  W.vec(p.posB);  W.vec(p.normal);
+    W.pod(p.d);  W.pod<uint32_t>(p.colorCode);
+  }
+  CHECK(os.good(), "failed writing snapshot '" <<filename <<"'");
+}
+
+void rai::KinematicWorld::readSnapshot(const char* filename) {
+  std::shared_ptr<MappedFile> file = make_shared<MappedFile>(filename);
+  CHECK(file->p, "could not open snapshot '" <<filename <<"'");
+  Reader R(file->p, file->n);
+  char magic[8];
+  R.bytes(magic, 8);
+  CHECK(!memcmp(magic, snapshotMagic, 8), "'" <<filename <<"' is not a KinematicWorld snapshot");
+  uint32_t version = R.pod<uint32_t>();
+  CHECK(version>=1 && version<=snapshotVersion, "snapshot '" <<filename <<"' has an unsupported version " <<version);
+
+  clear();
+
+  rai::Array<ptr<Mesh>> meshes(R.pod<uint32_t>());
+  for(ptr<Mesh>& m:meshes) { m = make_shared<Mesh>(); readMesh(R, *m, file, version); }
+
+  uint32_t nFrames = R.pod<uint32_t>();
+  intA parents(nFrames), mimics(nFrames);
+  mimics = -1;
+  for(uint i=0; i<nFrames; i++) {
+    Frame *f = new Frame(*this);
+    R.str(f->name);
+    parents(i) = R.pod<int32_t>();
+    R.trans(f->Q);  R.trans(f->X);
+    f->tau = R.pod<double>();
+    f->active = R.pod<uint8_t>();
+    f->flags = R.pod<int32_t>();
+    if(!R.pod<uint8_t>()) readAts(R, f->ats);
+    else { rai::String txt; R.str(txt); f->ats.read(txt); }
+    uint8_t attached = R.pod<uint8_t>();
+
+    if(attached&1) {
+      Joint *j = new Joint(*f);
+      j->dim = R.pod<uint32_t>();  j->qIndex = R.pod<uint32_t>();  j->generator = R.pod<byte>();
+      R.array(j->limits);  R.array(j->q0);
+      j->H = R.pod<double>();  j->scale = R.pod<double>();
+      mimics(i) = R.pod<int32_t>();
+      R.vec(j->axis);
+      j->type = (JointType)R.pod<int32_t>();
+      j->constrainToZeroVel = R.pod<uint8_t>();  j->active = R.pod<uint8_t>();
+      if(R.pod<uint8_t>()) { new Uncertainty(j);  R.array(j->uncertainty->sigma); }
+    }
+    if(attached&2) {
+      Shape *s = new Shape(*f);
+      s->_type = (ShapeType)R.pod<int32_t>();
+      R.array(s->size);
+      s->cont = R.pod<char>();  s->visual = R.pod<uint8_t>();
+      int32_t m = R.pod<int32_t>(), c = R.pod<int32_t>();
+      s->_mesh = (m>=0 ? meshes(m) : ptr<Mesh>());
+      s->_sscCore = (c>=0 ? meshes(c) : ptr<Mesh>());
+    }
+    if(attached&4) {
+      Inertia *in = new Inertia(*f);
+      in->mass = R.pod<double>();  in->matrix = R.pod<Matrix>();  in->type = (BodyType)R.pod<int32_t>();
+      R.vec(in->com);  R.vec(in->force);  R.vec(in->torque);
+    }
+  }
+  for(uint i=0; i<nFrames; i++) {
+    if(parents(i)>=0) frames(i)->linkFrom(frames(parents(i)));
+    if(mimics(i)>=0) frames(i)->joint->mimic = frames(mimics(i))->joint;
+  }
+
+  calc_activeSets();
+  R.array(q);  R.array(qdot);
+
+  proxies.resize(R.pod<uint32_t>());
+  for(Proxy& p:proxies) {
+    p.a = frames(R.pod<int32_t>());  p.b = frames(R.pod<int32_t>());
+    R.vec(p.posA);  R.vec(p.posB);  R.vec(p.normal);
+    p.d = R.pod<double>();  p.colorCode = R.pod<uint32_t>();
+  }
+  CHECK_EQ(R.p, R.end, "trailing data in snapshot '" <<filename <<"'");
+}
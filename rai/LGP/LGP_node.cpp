@@ -154,10 +154,28 @@ void LGP_Node::optBound(BoundType bound, bool collisions, int verbose) {
 
   komo.useSwitches = tree->useSwitches;
 
+  //-- look up the bound cache (before the problem is set up): reuse the result, or at least warm start
+  static bool reuseCached = rai::getParameter<bool>("LGP/boundCacheReuse", true);
+  std::string cacheKey;
+  BoundCache::Entry *cached=NULL;
+  if(tree->boundCache.capacity && bound!=BD_poseFromSeq){
+    cacheKey = BoundCache::getKey(bound, S, startKinematics, collisions, tree->useSwitches,
+                                  waypoints, tree->finalGeometryObjectives.objectives);
+    cached = tree->boundCache.find(cacheKey);
+  }
+
+  //warm start from the parent's solution of the same bound (which solved the skeleton prefix)
+  static bool warmStart = rai::getParameter<bool>("LGP/warmStartBounds", false);
+  KOMO *prefix=NULL;
+  if(warmStart && !(cached && reuseCached) && parent && (bound==BD_seq || bound==BD_path || bound==BD_seqPath)
+     && parent->count(bound) && parent->feasible(bound) && parent->komoProblem(bound)){
+    prefix = parent->komoProblem(bound).get();
+  }
+
   skeleton2Bound(komo, bound, S,
                  startKinematics, (parent?parent->effKinematics:startKinematics),
                  collisions,
-                 waypoints);
+                 waypoints, prefix);
 
   for(Objective *o:tree->finalGeometryObjectives.objectives){
     cout <<"FINAL objective: " <<*o <<endl;
@@ -180,8 +198,16 @@ void LGP_Node::optBound(BoundType bound, bool collisions, int verbose) {
   if(komo.verbose>5) komo.animateOptimization = komo.verbose-5;
 
 
+  //-- the cached result is only used when it fits the problem as set up; otherwise it still warm starts
+  if(cached && cached->x.N!=komo.x.N) cached=NULL;
+  if(cached) komo.x = cached->x;
+  bool reused = cached && reuseCached;
+
   try {
-    if(bound != BD_poseFromSeq){
+    if(reused){
+      komo.set_x(cached->x);
+      komo.runTime = 0.;
+    }else if(bound != BD_poseFromSeq){
       komo.run();
     }else{
       CHECK_EQ(step, komo.T-1, "");
@@ -192,10 +218,12 @@ void LGP_Node::optBound(BoundType bound, bool collisions, int verbose) {
     komoProblem(bound).reset();
     return;
   }
-  if(!komo.denseOptimization && !komo.sparseOptimization) COUNT_evals += komo.opt->newton.evals;
-  COUNT_kin += rai::KinematicWorld::setJointStateCount;
-  COUNT_opt(bound)++;
-  COUNT_time += komo.runTime;
+  if(!reused){
+    if(!komo.denseOptimization && !komo.sparseOptimization) COUNT_evals += komo.opt->newton.evals;
+    COUNT_kin += rai::KinematicWorld::setJointStateCount;
+    COUNT_opt(bound)++;
+    COUNT_time += komo.runTime;
+  }
   count(bound)++;
   
   DEBUG(komo.getReport(false, 1, FILE("z.problem")););
@@ -203,16 +231,32 @@ void LGP_Node::optBound(BoundType bound, bool collisions, int verbose) {
 //  komo.reportProxies(cout, 0.);
 //  komo.checkGradients();
 
-  Graph result = komo.getReport((komo.verbose>0 && bound>=2));
-  DEBUG(FILE("z.problem.cost") <<result;);
-  double cost_here = result.get<double>({"total","sqrCosts"});
-  double constraints_here = result.get<double>({"total","constraints"});
-  if(bound == BD_poseFromSeq){
-    cost_here = komo.sos;
-    constraints_here = komo.ineq + komo.eq;
+  double cost_here, constraints_here;
+  if(reused){
+    cost_here = cached->cost;
+    constraints_here = cached->constraints;
+  }else{
+    Graph result = komo.getReport((komo.verbose>0 && bound>=2));
+    DEBUG(FILE("z.problem.cost") <<result;);
+    cost_here = result.get<double>({"total","sqrCosts"});
+    constraints_here = result.get<double>({"total","constraints"});
+    if(bound == BD_poseFromSeq){
+      cost_here = komo.sos;
+      constraints_here = komo.ineq + komo.eq;
+    }
   }
   bool feas = (constraints_here<1.);
 
+  if(cacheKey.size() && !reused){
+    BoundCache::Entry e;
+    e.cost = cost_here;
+    e.constraints = constraints_here;
+    e.feasible = feas;
+    e.computeTime = komo.runTime;
+    e.x = komo.x;
+    tree->boundCache.add(cacheKey, e);
+  }
+
   if(komo.verbose>0){
     cout <<"  RESULTS: cost: " <<cost_here <<" constraints: " <<constraints_here <<" feasible: " <<feas <<endl;
   }
@@ -118,6 +118,10 @@ LGP_Tree::LGP_Tree()
   if(verbose>0) fil.open(dataPath + "optLGP.dat"); //STRING("z.optLGP." <<rai::date() <<".dat"));
 
   cameraFocus = rai::getParameter<arr>("LGP/cameraFocus", {});
+
+  boundCache.capacity = rai::getParameter<uint>("LGP/boundCacheSize", 0);
+  boundCache.fileName = rai::getParameter<rai::String>("LGP/boundCacheFile", "");
+  if(boundCache.capacity && boundCache.fileName.N) boundCache.load(boundCache.fileName);
 }
 
 LGP_Tree::LGP_Tree(const rai::KinematicWorld& _kin, const char *folFileName) : LGP_Tree() {
@@ -153,9 +157,9 @@ LGP_Tree::~LGP_Tree() {
 void LGP_Tree::initDisplay() {
   if(verbose>2 && !views.N) {
     views.resize(4);
-    views(1) = make_shared<KinPathViewer>(Var<WorldL>(), 1.2, -1);
-    views(2) = make_shared<KinPathViewer>(Var<WorldL>(), 1.2, -1);
-    views(3) = make_shared<KinPathViewer>(Var<WorldL>(), .05, -2);
+    views(1) = make_shared<KinPathViewer>(Var<arr>(), 1.2, -1);
+    views(2) = make_shared<KinPathViewer>(Var<arr>(), 1.2, -1);
+    views(3) = make_shared<KinPathViewer>(Var<arr>(), .05, -2);
     for(auto& v:views) if(v) v->copy.orsDrawJoints=v->copy.orsDrawMarkers=v->copy.orsDrawProxies=false;
   }
   if(!dth) dth = new DisplayThread(this);
@@ -539,6 +543,7 @@ rai::String LGP_Tree::report(bool detailed) {
    <<" bestSeq= " <<(bseq ?bseq ->cost(2):100.)
   <<" bestPath= " <<(bpath?bpath->cost(displayBound):100.)
   <<" #solutions= " <<fringe_solved.N;
+  if(boundCache.capacity) out <<' ' <<boundCache;
 
   //  if(bseq) displayFocus=bseq;
   //  if(bpath) displayFocus=bpath;
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "LGP_node.h"
+#include "boundCache.h"
 #include <Core/thread.h>
 
 struct KinPathViewer;
@@ -50,6 +51,7 @@ struct LGP_Tree : GLDrawer {
   rai::KinematicWorld kin;
 
   KOMO finalGeometryObjectives;
+  BoundCache boundCache;  ///< results of bounds for recurring skeletons (also over runs, if LGP/boundCacheFile is set)
   
   rai::Array<std::shared_ptr<KinPathViewer>> views; //displays for the 3 different levels
   
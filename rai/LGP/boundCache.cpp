@@ -0,0 +1,159 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2017 Marc Toussaint
+    email: marc.toussaint@informatik.uni-stuttgart.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "boundCache.h"
+#include <KOMO/objective.h>
+#include <Kin/frame.h>
+
+//===========================================================================
+
+/// writes the key material in a canonical binary form; doubles are quantized so that round-off noise does not change the key
+struct KeyWriter {
+  std::string key;
+  void bytes(const void* p, uint n) { key.append((const char*)p, n); }
+  void operator()(int64_t i) { bytes(&i, sizeof(i)); }
+  void operator()(double d) { operator()((int64_t)::round(d*1e6)); }
+  void operator()(const char* s) { int64_t n=strlen(s); operator()(n); bytes(s, n); }
+  void operator()(const arr& x) { operator()((int64_t)x.N); for(double d:x) operator()(d); }
+  void operator()(const rai::Transformation& X) {
+    operator()(X.pos.x); operator()(X.pos.y); operator()(X.pos.z);
+    operator()(X.rot.w); operator()(X.rot.x); operator()(X.rot.y); operator()(X.rot.z);
+  }
+};
+
+std::string BoundCache::getKey(BoundType bound, const Skeleton& S, const rai::KinematicWorld& K,
+                               bool collisions, bool useSwitches, const arrA& waypoints, const rai::Array<Objective*>& finalObjectives) {
+  KeyWriter W;
+  W((int64_t)bound);
+  W((int64_t)collisions);
+  W((int64_t)useSwitches);
+
+  //-- skeleton, independent of the order of entries
+  StringA entries;
+  for(const SkeletonEntry& s:S) entries.append(STRING(s));
+  entries.sort();
+  W((int64_t)entries.N);
+  for(const rai::String& s:entries) W(s.p);
+
+  //-- start state: all frames when collisions are considered, otherwise those of the skeleton and their parents
+  uintA ids; //frame IDs (not pointers: the key needs to be reproducible over runs)
+  if(collisions) ids.setStraightPerm(K.frames.N);
+  else {
+    for(const SkeletonEntry& s:S) for(const rai::String& name:s.frames) {
+      rai::Frame *f = K.getFrameByName(name, false);
+      if(f) for(rai::Frame *p:f->getPathToRoot()) ids.append(p->ID);
+    }
+    ids.sort().removeDoublesInSorted();
+  }
+  W((int64_t)ids.N);
+  for(uint i:ids) {
+    rai::Frame *f = K.frames(i);
+    W(f->name.p);
+    W(f->X);
+    if(f->shape) { W((int64_t)f->shape->_type.x); W(f->shape->size); }
+    else W((int64_t)-1);
+  }
+  W(K.q);
+
+  //-- everything else skeleton2Bound and the node set the KOMO problem up from
+  W((int64_t)rai::getParameter<uint>("LGP/stepsPerPhase", 10));
+  W((int64_t)rai::getParameter<uint>("LGP/pathOrder", 2));
+  W((int64_t)waypoints.N);
+  for(const arr& q:waypoints) W(q);
+  W((int64_t)finalObjectives.N);
+  for(Objective *ob:finalObjectives) {
+    W(ob->name.p);
+    W((int64_t)ob->type.x);
+    W((int64_t)ob->map->order);
+    W(ob->map->scale);
+    W(ob->map->target);
+  }
+  return W.key;
+}
+
+//===========================================================================
+
+BoundCache::BoundCache(uint _capacity, const char* _fileName)
+  : capacity(_capacity), fileName(_fileName) {
+  if(capacity && fileName.N) load(fileName);
+}
+
+BoundCache::~BoundCache() {
+  if(capacity && fileName.N) save(fileName);
+}
+
+BoundCache::Entry* BoundCache::find(const std::string& key) {
+  auto it = entries.find(key);
+  if(it==entries.end()) { misses++; return NULL; }
+  hits++;
+  lru.splice(lru.begin(), lru, it->second.use);
+  return &it->second.entry;
+}
+
+void BoundCache::add(const std::string& key, const Entry& entry) {
+  if(!capacity) return;
+  auto it = entries.find(key);
+  if(it==entries.end()) {
+    it = entries.emplace(key, Slot()).first;
+    lru.push_front(&it->first);
+  } else {
+    lru.splice(lru.begin(), lru, it->second.use);
+  }
+  it->second.entry = entry;
+  it->second.use = lru.begin();
+  while(entries.size()>capacity) {
+    entries.erase(*lru.back());
+    lru.pop_back();
+    evictions++;
+  }
+}
+
+void BoundCache::clear() {
+  entries.clear();
+  lru.clear();
+  hits=misses=evictions=0;
+}
+
+bool BoundCache::load(const char* filename) {
+  std::ifstream is(filename, std::ios::binary);
+  if(!is.good()) return false;
+  uint n;
+  std::string key;
+  Entry e;
+  for(;;) {
+    is >>n;
+    if(!is.good()) break;
+    is.get(); //the separating space
+    key.resize(n);
+    is.read(&key[0], n);
+    is >>e.cost >>e.constraints >>e.feasible >>e.computeTime;
+    if(!is.good()) break;
+    e.x.read(is);
+    add(key, e); //the file is in order of use: the last one read is the most recent
+  }
+  return true;
+}
+
+void BoundCache::save(const char* filename) const {
+  std::ofstream os(filename, std::ios::binary);
+  CHECK(os.good(), "could not open bound cache file '" <<filename <<"'");
+  os.precision(17);
+  for(auto it=lru.rbegin(); it!=lru.rend(); it++) {
+    const std::string& key = **it;
+    const Entry& e = entries.at(key).entry;
+    os <<key.size() <<' ';
+    os.write(key.data(), key.size());
+    os <<' ' <<e.cost <<' ' <<e.constraints <<' ' <<e.feasible <<' ' <<e.computeTime <<' ';
+    e.x.write(os, " ", "\n ", "[]", true, true);
+    os <<endl;
+  }
+}
+
+void BoundCache::write(ostream& os) const {
+  os <<"CACHE= " <<entries.size() <<" HITS= " <<hits <<" MISSES= " <<misses <<" EVICTED= " <<evictions;
+}
@@ -0,0 +1,52 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2017 Marc Toussaint
+    email: marc.toussaint@informatik.uni-stuttgart.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include "bounds.h"
+#include <unordered_map>
+#include <list>
+
+/// cache of bound results, keyed by a canonical description of the bound problem: the bound type,
+/// the (sorted) skeleton, the relevant start-state frames, and everything else skeleton2Bound sets the
+/// KOMO problem up from (waypoints, parameters, extra objectives). The key is computed from these
+/// inputs before any KOMO is set up, and entries are stored under the full key (not a hash of it).
+/// Least recently used entries are evicted beyond 'capacity'. If a file is given, the cache is
+/// loaded on construction and saved on destruction, so that it persists over planning runs.
+struct BoundCache {
+  struct Entry {
+    double cost=0., constraints=0., computeTime=0.;
+    bool feasible=false;
+    arr x;         ///< the solution (decision variables)
+  };
+
+  uint capacity;           ///< maximal number of entries; 0 disables the cache
+  rai::String fileName;    ///< on-disk storage (may be empty)
+  uint hits=0, misses=0, evictions=0;
+
+  BoundCache(uint _capacity=0, const char* _fileName=NULL);
+  ~BoundCache();
+
+  static std::string getKey(BoundType bound, const Skeleton& S, const rai::KinematicWorld& startKinematics,
+                            bool collisions, bool useSwitches, const arrA& waypoints, const rai::Array<Objective*>& finalObjectives);
+
+  Entry* find(const std::string& key);                ///< counts a hit or miss; NULL if not cached
+  void add(const std::string& key, const Entry& entry); ///< insert or overwrite; evicts the least recently used beyond capacity
+  uint size() const { return entries.size(); }
+  void clear();
+
+  bool load(const char* filename);
+  void save(const char* filename) const;              ///< in order of use, least recent first
+  void write(ostream& os) const;                      ///< statistics
+
+private:
+  struct Slot { Entry entry; std::list<const std::string*>::iterator use; };
+  std::unordered_map<std::string, Slot> entries;
+  std::list<const std::string*> lru;                  ///< keys of 'entries', most recently used first
+};
+stdOutPipe(BoundCache)
@@ -6,6 +6,7 @@
 #include <Kin/TM_default.h>
 
 double conv_step2time(int step, uint stepsPerPhase);
+int conv_time2step(double time, uint stepsPerPhase);
 
 template<> const char* rai::Enum<BoundType>::names []= {
   "symbolic",
@@ -24,13 +25,21 @@ rai::Array<SkeletonSymbol> modes = { SY_stable, SY_stableOn, SY_dynamic, SY_dyna
 void skeleton2Bound(KOMO& komo, BoundType boundType, const Skeleton& S,
                     const rai::KinematicWorld& startKinematics,
                     const rai::KinematicWorld& effKinematics,
-                    bool collisions, const arrA& waypoints){
+                    bool collisions, const arrA& waypoints, KOMO* prefix){
   double maxPhase=0;
   for(const SkeletonEntry& s:S){
     if(s.phase0>maxPhase) maxPhase=s.phase0;
     if(s.phase1>maxPhase) maxPhase=s.phase1;
   }
   komo.clearObjectives();
+
+  //the prefix shares all steps before the latest skeleton entry
+  auto warmStart = [&komo, prefix, maxPhase](bool holdRest){
+    if(!prefix) return;
+    int sharedSteps = conv_time2step(maxPhase, komo.stepsPerPhase);
+    if(sharedSteps>0) komo.initWithPrefix(*prefix, sharedSteps, holdRest);
+  };
+
   //-- prepare the komo problem
   switch(boundType) {
     case BD_pose: {
@@ -118,6 +127,7 @@ void skeleton2Bound(KOMO& komo, BoundType boundType, const Skeleton& S,
       if(collisions) komo.add_collision(true);
 
       komo.reset();
+      warmStart(true);
 //      komo.setPairedTimes();
       //      cout <<komo.getPath_times() <<endl;
     } break;
@@ -142,6 +152,7 @@ void skeleton2Bound(KOMO& komo, BoundType boundType, const Skeleton& S,
       if(collisions) komo.add_collision(true, 0., 1e1);
 
       komo.reset();
+      warmStart(true);
       //      cout <<komo.getPath_times() <<endl;
     } break;
     case BD_seqPath: {
@@ -177,6 +188,7 @@ void skeleton2Bound(KOMO& komo, BoundType boundType, const Skeleton& S,
 
       komo.reset();
       komo.initWithWaypoints(waypoints, waypointsStepsPerPhase);
+      warmStart(false);
       //      cout <<komo.getPath_times() <<endl;
     } break;
 
@@ -18,7 +18,8 @@ void skeleton2Bound(KOMO& komo,
                     const rai::KinematicWorld& startKinematics,
                     const rai::KinematicWorld& parentEffKinematics,
                     bool collisions,
-                    const arrA& waypoints={}
+                    const arrA& waypoints={},
+                    KOMO* prefix=NULL ///< optional: the solved KOMO of the same bound for the parent skeleton (warm start of BD_seq, BD_path, BD_seqPath)
                     );
 
 
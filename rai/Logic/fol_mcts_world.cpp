@@ -134,6 +134,7 @@ MCTS_Environment::TransitionReturn FOL_World::transition(const Handle& action) {
     lastDecisionInState = createNewFact(*state, {Wait_keyword});
     lastDecisionInState->keys.append("decision");
   }
+  state->invalidateKeyIndex();
   
   //-- apply effects of decision
   if(d->waitDecision) {
@@ -288,6 +289,7 @@ void FOL_World::make_current_state_new_start() {
   if(!start_state) start_state = &KB.newSubgraph({"START_STATE"}, state->isNodeOfGraph->parents);
   start_state->copy(*state);
   start_state->isNodeOfGraph->keys(0)="START_STATE";
+  KB.invalidateKeyIndex();
   start_T_step = T_step;
   start_T_real = T_real;
   DEBUG(KB.checkConsistency();)
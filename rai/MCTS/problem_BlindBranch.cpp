@@ -12,7 +12,7 @@ BlindBranch::BlindBranch(uint H):H(H) {
   actions = { Handle(new Action(-1)), Handle(new Action(+1)) };
 }
 
-void BlindBranch::reset_state() { state=0; T=0; }
+void BlindBranch::reset_state() { state=startState; T=startT; }
 
 MCTS_Environment::TransitionReturn BlindBranch::transition(const MCTS_Environment::Handle& action) {
   state += std::dynamic_pointer_cast<const Action>(action)->d;
@@ -31,7 +31,7 @@ const std::vector<MCTS_Environment::Handle> BlindBranch::get_actions() {
   return conv_arr2stdvec(actions);
 }
 
-const MCTS_Environment::Handle BlindBranch::get_state() {
+const MCTS_Environment::Handle BlindBranch::get_stateCopy() {
   return MCTS_Environment::Handle(new State(state, T));
 }
 
@@ -43,6 +43,8 @@ void BlindBranch::set_state(const MCTS_Environment::Handle& _state) {
 
 bool BlindBranch::is_terminal_state() const { return T>=H; }
 
+void BlindBranch::make_current_state_new_start() { startState=state; startT=T; }
+
 bool BlindBranch::get_info(InfoTag tag) const {
   switch(tag) {
     case hasTerminal: return true;
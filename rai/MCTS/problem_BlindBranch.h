@@ -31,6 +31,7 @@ struct BlindBranch:MCTS_Environment {
   int state; //the state = sum of so-far actions
   int T; //current time (part of the state, actually!)
   int H; //horizon (parameter of the world)
+  int startState=0, startT=0; //set by make_current_state_new_start
   rai::Array<Handle> actions; //will contain handles on the -1 and +1 action
   
   BlindBranch(uint H);
@@ -38,9 +39,10 @@ struct BlindBranch:MCTS_Environment {
   TransitionReturn transition(const Handle& action);
   TransitionReturn transition_randomly();
   const std::vector<Handle> get_actions();
-  const Handle get_state();
+  const Handle get_stateCopy();
   void set_state(const Handle& _state);
   bool is_terminal_state() const;
+  void make_current_state_new_start();
   
   bool get_info(InfoTag tag) const;
   double get_info_value(InfoTag tag) const;
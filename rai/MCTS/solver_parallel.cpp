@@ -0,0 +1,247 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2017 Marc Toussaint
+    email: marc.toussaint@informatik.uni-stuttgart.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "solver_parallel.h"
+#include <Core/thread.h>
+
+#include <mutex>
+#include <atomic>
+#include <random>
+
+//===========================================================================
+
+PMCTS_Node* PMCTS_NodePool::alloc(uint n) {
+  if(!blocks.N || used+n>blockSize) {
+    blocks.append(new PMCTS_Node[std::max(n, blockSize)]);
+    used=0;
+  }
+  PMCTS_Node *p = blocks.last()+used;
+  used += n;
+  N += n;
+  return p;
+}
+
+void PMCTS_NodePool::clear() {
+  for(PMCTS_Node *b:blocks) delete[] b;
+  blocks.clear();
+  used=N=0;
+}
+
+//===========================================================================
+
+struct PMCTS_Tree {
+  PMCTS_NodePool pool;
+  PMCTS_Node *root;
+  std::mutex mutex;
+  PMCTS_Tree() { root = pool.alloc(1); }
+};
+
+struct sParallelMCTS {
+  rai::Array<PMCTS_Tree*> trees;
+  ~sParallelMCTS() { clear(); }
+  void clear() { for(PMCTS_Tree *T:trees) delete T; trees.clear(); }
+};
+
+//tree policy at an expanded node: unvisited children first (in order), then UCB with virtual loss
+static PMCTS_Node* selectChild(PMCTS_Node *n, double beta, double virtualLoss) {
+  for(uint i=0; i<n->numChildren; i++) {
+    PMCTS_Node *ch = n->children+i;
+    if(!ch->N && !ch->virtualVisits) return ch;
+  }
+  double c = beta*sqrt(2.*::log(n->N+n->virtualVisits));
+  PMCTS_Node *best=NULL;
+  double bestQ=0.;
+  for(uint i=0; i<n->numChildren; i++) {
+    PMCTS_Node *ch = n->children+i;
+    double N = ch->N + ch->virtualVisits;
+    double Q = (ch->Q - virtualLoss*ch->virtualVisits)/N + c/sqrt(N);
+    if(!best || Q>bestQ) { best=ch; bestQ=Q; }
+  }
+  return best;
+}
+
+//one rollout on tree T with environment W; the tree is only locked for selection, expansion, and backup
+//(all node fields are read and written under the lock; the environment only sees copies)
+static void rollout(ParallelMCTS& P, PMCTS_Tree& T, MCTS_Environment& W, std::mt19937& gen, int stepAbort) {
+  rai::Array<PMCTS_Node*> path;
+  uintA numDecisions; //# of children of path(k)->parent, as seen during selection
+  arr rewards;
+  int step=0;
+  bool expand;
+
+  //-- tree policy: descend as far as the tree is expanded
+  {
+    std::lock_guard<std::mutex> lock(T.mutex);
+    PMCTS_Node *n = T.root;
+    n->virtualVisits++;
+    path.append(n);
+    while(n->expanded && n->numChildren && (stepAbort<0 || (int)n->t<stepAbort)) {
+      numDecisions.append(n->numChildren);
+      n = selectChild(n, P.beta, P.virtualLoss);
+      n->virtualVisits++;
+      path.append(n);
+    }
+    expand = !n->expanded && n->N;
+  }
+
+  //-- replay the tree decisions in the environment
+  W.reset_state();
+  for(uint k=1; k<path.N; k++) {
+    std::vector<MCTS_Environment::Handle> A = W.get_actions();
+    CHECK_EQ(A.size(), numDecisions(k-1), "the environment copies do not list the same decisions");
+    rewards.append(W.transition(A[path(k)->action]).reward);
+    step++;
+  }
+
+  //-- expand a leaf that has been visited before, and step into its first free child
+  PMCTS_Node *leaf = path.last();
+  if(expand && (stepAbort<0 || step<stepAbort)) {
+    uint nA=0;
+    std::vector<MCTS_Environment::Handle> A;
+    if(!W.is_terminal_state()) { A = W.get_actions(); nA=A.size(); }
+    PMCTS_Node *n=NULL;
+    {
+      std::lock_guard<std::mutex> lock(T.mutex);
+      if(!leaf->expanded) { //another thread might have been faster
+        if(nA) {
+          leaf->children = T.pool.alloc(nA);
+          for(uint i=0; i<nA; i++) {
+            PMCTS_Node *ch = leaf->children+i;
+            ch->parent = leaf;
+            ch->action = i;
+            ch->t = leaf->t+1;
+          }
+        }
+        leaf->numChildren = nA;
+        leaf->expanded = true;
+        if(P.verbose>2) cout <<"PMCTS: expanded node at depth " <<leaf->t <<" with " <<nA <<" decisions" <<endl;
+      }
+      if(leaf->numChildren) {
+        n = selectChild(leaf, P.beta, P.virtualLoss);
+        n->virtualVisits++;
+        path.append(n);
+      }
+    }
+    if(n) {
+      rewards.append(W.transition(A[n->action]).reward);
+      step++;
+    }
+  }
+
+  //-- random rollout
+  double Return_rollout=0.;
+  while(!W.is_terminal_state() && (stepAbort<0 || step<stepAbort)) {
+    std::vector<MCTS_Environment::Handle> A = W.get_actions();
+    if(!A.size()) break;
+    Return_rollout += W.transition(A[gen()%A.size()]).reward;
+    step++;
+  }
+  if(stepAbort>=0 && step>=stepAbort) Return_rollout -= 100.;
+  if(P.verbose>1) cout <<"PMCTS: terminal state reached; step=" <<step <<" Return=" <<sum(rewards)+Return_rollout <<endl;
+
+  //-- backup (and release the virtual loss)
+  {
+    std::lock_guard<std::mutex> lock(T.mutex);
+    double Return_togo = Return_rollout;
+    for(uint k=path.N; k--;) {
+      PMCTS_Node *n = path(k);
+      double r = k ? rewards(k-1) : 0.;
+      n->N++;
+      n->R += r;
+      Return_togo += r;
+      n->Q += Return_togo;
+      n->virtualVisits--;
+    }
+  }
+}
+
+//===========================================================================
+
+ParallelMCTS::ParallelMCTS(const rai::Array<MCTS_Environment*>& worlds, Mode mode)
+  : s(new sParallelMCTS), worlds(worlds), mode(mode) {
+  CHECK(worlds.N, "need at least one environment");
+  clear();
+}
+
+ParallelMCTS::~ParallelMCTS() {
+  delete s;
+}
+
+void ParallelMCTS::clear() {
+  s->clear();
+  uint n = (mode==rootParallel ? worlds.N : 1);
+  for(uint i=0; i<n; i++) s->trees.append(new PMCTS_Tree);
+  rollouts=0;
+}
+
+void ParallelMCTS::addRollouts(uint n, int stepAbort) {
+  std::atomic<uint> count(0);
+  uintA seeds(worlds.N); //the global generator is not thread-safe: seed per-thread generators here
+  for(uint& seed:seeds) seed = rnd.num();
+  parallelFor(worlds.N, [this, &count, &seeds, n, stepAbort](uint w) {
+    PMCTS_Tree& T = *s->trees(mode==rootParallel ? w : 0);
+    std::mt19937 gen(seeds(w));
+    while(count++<n) rollout(*this, T, *worlds(w), gen, stepAbort);
+  }, worlds.N);
+  rollouts += n;
+}
+
+uintA ParallelMCTS::Nvisits() {
+  uintA N;
+  for(PMCTS_Tree *T:s->trees) {
+    PMCTS_Node *r = T->root;
+    if(!r->expanded) continue;
+    if(!N.N) N.resize(r->numChildren).setZero();
+    CHECK_EQ(N.N, r->numChildren, "trees disagree on the root decisions");
+    for(uint i=0; i<r->numChildren; i++) N(i) += r->children[i].N;
+  }
+  return N;
+}
+
+arr ParallelMCTS::Qfunction(int optimistic) {
+  uintA N = Nvisits();
+  arr Q = zeros(N.N);
+  uint Nroot=0;
+  for(PMCTS_Tree *T:s->trees) {
+    PMCTS_Node *r = T->root;
+    Nroot += r->N;
+    if(r->expanded) for(uint i=0; i<r->numChildren; i++) Q(i) += r->children[i].Q;
+  }
+  double c = beta*sqrt(2.*::log(Nroot));
+  for(uint i=0; i<Q.N; i++) {
+    if(!N(i)) { Q(i) = (optimistic==+1 ? 1e10 : -1e10); continue; }
+    Q(i) /= N(i);
+    if(optimistic) Q(i) += optimistic*c/sqrt(N(i));
+  }
+  return Q;
+}
+
+uint ParallelMCTS::getBestActionIdx() {
+  arr Q = Qfunction(0);
+  CHECK(Q.N, "no decisions at the root yet");
+  return Q.maxIndex();
+}
+
+MCTS_Environment::Handle ParallelMCTS::getBestAction() {
+  uint a = getBestActionIdx();
+  worlds(0)->reset_state();
+  return worlds(0)->get_actions()[a];
+}
+
+uint ParallelMCTS::Nnodes() {
+  uint n=0;
+  for(PMCTS_Tree *T:s->trees) n += T->pool.N;
+  return n;
+}
+
+void ParallelMCTS::report(ostream& os) {
+  os <<"ParallelMCTS (" <<(mode==rootParallel?"root":"tree") <<"-parallel, threads=" <<worlds.N <<") rollouts=" <<rollouts <<" nodes=" <<Nnodes() <<endl;
+  uintA N = Nvisits();
+  arr Q = Qfunction(0);
+  for(uint i=0; i<N.N; i++) os <<"  decision " <<i <<" N=" <<N(i) <<" Q=" <<Q(i) <<endl;
+}
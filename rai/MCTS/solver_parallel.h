@@ -0,0 +1,81 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2017 Marc Toussaint
+    email: marc.toussaint@informatik.uni-stuttgart.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include <Core/array.h>
+
+#include "environment.h"
+
+//===========================================================================
+
+/// a node of the parallel search tree; a decision is referred to by its index in get_actions()
+/// (handles of different environment copies are not comparable), which requires all copies to
+/// list their actions in the same order
+struct PMCTS_Node {
+  PMCTS_Node *parent=NULL;
+  PMCTS_Node *children=NULL; ///< contiguous block of numChildren nodes, allocated from the pool on expansion
+  uint numChildren=0;
+  bool expanded=false;
+  uint action=0;             ///< index of the decision (relative to the parent)
+  uint t=0;                  ///< depth of this node
+  uint N=0;                  ///< # of visits
+  uint virtualVisits=0;      ///< # of rollouts currently passing through this node
+  double R=0.;               ///< total immediate rewards
+  double Q=0.;               ///< total returns
+};
+
+/// arena for nodes: allocates in large blocks, frees only as a whole
+struct PMCTS_NodePool {
+  uint blockSize;
+  rai::Array<PMCTS_Node*> blocks;
+  uint used=0;  ///< # of nodes used in the last block
+  uint N=0;     ///< total # of allocated nodes
+  PMCTS_NodePool(uint blockSize=1<<14) : blockSize(blockSize) {}
+  ~PMCTS_NodePool() { clear(); }
+  PMCTS_Node* alloc(uint n); ///< n contiguous nodes
+  void clear();
+};
+
+//===========================================================================
+
+/// MCTS (UCT with on-policy returns, as in solver_marc.h) with rollouts distributed over threads.
+/// Each thread owns one environment copy (given by the caller, all in the same start state).
+/// - treeParallel: all threads work on one tree; a rollout marks its path with a virtual loss
+///   so that concurrent rollouts diversify. Only selection, expansion, and backup lock the tree;
+///   environment transitions run concurrently.
+/// - rootParallel: each thread grows an own tree; statistics are merged at the root.
+/// Random rollout decisions are drawn from per-thread generators (not via transition_randomly).
+struct ParallelMCTS {
+private:
+  struct sParallelMCTS *s;
+public:
+  enum Mode { treeParallel, rootParallel };
+
+  rai::Array<MCTS_Environment*> worlds; ///< one per thread
+  Mode mode;
+  double beta=2.;          ///< UCB exploration
+  double virtualLoss=1.;   ///< return subtracted per virtual visit in the tree policy
+  int verbose=0;
+  uint rollouts=0;
+
+  ParallelMCTS(const rai::Array<MCTS_Environment*>& worlds, Mode mode=treeParallel);
+  ~ParallelMCTS();
+
+  void addRollouts(uint n, int stepAbort=-1);  ///< n more rollouts, distributed over the threads
+  void clear();
+
+  arr Qfunction(int optimistic=0);  ///< value estimates of the root decisions, merged over trees
+  uintA Nvisits();                  ///< visit counts of the root decisions, merged over trees
+  uint getBestActionIdx();
+  MCTS_Environment::Handle getBestAction(); ///< (the handle of worlds(0), which is reset)
+  uint Nnodes();
+  void report(ostream& os);
+};
+
+//===========================================================================
@@ -25,8 +25,9 @@ arr SplineRunner::run(double dt, arr& qref_dot){
         //read out the new reference
         phase += dt;
         double maxPhase = refSpline.times.last();
-        arr q_ref = refSpline.eval(phase);
-        if(!!qref_dot) qref_dot = refSpline.eval(phase, 1);
+        arr q_ref(refSpline.points.d1);
+        if(!!qref_dot) qref_dot.resize(q_ref.N);
+        refSpline.eval(q_ref.p, !!qref_dot?qref_dot.p:NULL, NULL, phase); //position and velocity in one pass
         if(phase>maxPhase){ //clear spline buffer
             q_ref = refPoints[-1];
             stop();
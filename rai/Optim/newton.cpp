@@ -9,6 +9,8 @@
 #include <iomanip>
 
 #include "newton.h"
+#include <Core/profile.h>
+#include <Core/thread.h>
 
 bool sanityCheck=false; //true;
 
@@ -31,6 +33,7 @@ OptNewton::OptNewton(arr& _x, const ScalarFunction& _f,  OptOptions _o, ostream*
 
 void OptNewton::reinit(const arr& _x) {
   if(&x!=&_x) x = _x;
+  modelRadius = -1.;
   fx = f(gx, Hx, x);  evals++;
   if(additionalRegularizer)  fx += scalarProduct(x,(*additionalRegularizer)*vectorShaped(x));
   
@@ -47,6 +50,8 @@ void OptNewton::reinit(const arr& _x) {
 //===========================================================================
 
 OptNewton::StopCriterion OptNewton::step() {
+  rai::ArrayPoolScope pool; //temporaries (also of the problem's evaluations) recycle memory instead of using the global allocator
+  rai::ProfileScope profile("Newton/iteration");
   double fy;
   arr y, gy, Hy, Delta;
   
@@ -55,7 +60,7 @@ OptNewton::StopCriterion OptNewton::step() {
   
   if(!(fx==fx)) HALT("you're calling a newton step with initial function value = NAN");
 
-  rai::timerRead(true);
+  double time = rai::profileClock();
   //-- compute Delta
   arr R=Hx;
   if(beta) { //Levenberg Marquardt damping
@@ -67,12 +72,12 @@ OptNewton::StopCriterion OptNewton::step() {
       for(uint i=0; i<R.d0; i++) R.sparse().addEntry(i,i) = beta;
     }else NIY;
   }
+  bool inversionFailed=false;
   if(additionalRegularizer) { //obsolete -> retire
     if(isRowShifted(R)) R = unpack(R);
     else if(!isNotSpecial(R)) NIY;
     Delta = lapack_Ainv_b_sym(R + (*additionalRegularizer), -(gx+(*additionalRegularizer)*vectorShaped(x)));
   } else {
-    bool inversionFailed=false;
     try {
       if(!rootFinding){
         Delta = lapack_Ainv_b_sym(R, -gx);
@@ -102,6 +107,11 @@ OptNewton::StopCriterion OptNewton::step() {
     }
   }
 
+  //curvature of the quadratic model along Delta: (R+beta) Delta = -g  =>  Delta^T H Delta = -g^T Delta - beta |Delta|^2
+  double gDelta = scalarProduct(gx, Delta);
+  double DHD = -gDelta - beta*sumOfSqr(Delta);
+  bool modelValid = o.modelRejection && !additionalRegularizer && !rootFinding && !inversionFailed && gDelta<0.;
+
   //chop Delta to stay within bounds
   if(bound_lo.N && bound_hi.N) {
     double a=1.;
@@ -112,12 +122,17 @@ OptNewton::StopCriterion OptNewton::step() {
     if(a<1.) {
       if(o.verbose>1) cout <<" \tboundClip=" <<std::setw(11) <<a <<flush;
       Delta *= a;
+      gDelta *= a;  DHD *= a*a;
     }
   }
   
   //restrict stepsize
   double maxDelta = absMax(Delta);
-  if(o.maxStep>0. && maxDelta>o.maxStep) {  Delta *= o.maxStep/maxDelta; maxDelta = o.maxStep; }
+  if(o.maxStep>0. && maxDelta>o.maxStep) {
+    double a = o.maxStep/maxDelta;
+    Delta *= a;  maxDelta = o.maxStep;
+    gDelta *= a;  DHD *= a*a;
+  }
   double alphaHiLimit = o.maxStep/maxDelta;
   double alphaLoLimit = 1e-1*o.stopTolerance/maxDelta;
 
@@ -128,21 +143,50 @@ OptNewton::StopCriterion OptNewton::step() {
     if(o.verbose>1) cout <<" \t - NO UPDATE" <<endl;
     return stopCriterion=stopCrit1;
   }
-  timeNewton += rai::timerRead(true);
+  time = rai::profileClock()-time;
+  timeNewton += time;
+  rai::profileTime("Newton/solve", time);
+
+  //the quadratic model predicts the Wolfe condition to fail beyond this step size (if it curves upward along Delta)
+  double alphaModelLimit = -1.;
+  if(modelValid && DHD>0.) alphaModelLimit = 2.*(1.-o.wolfe)*(-gDelta)/DHD;
 
   //-- line search along Delta
+  time = rai::profileClock();
+  uint evalsBefore=evals;
   uint lineSearchSteps=0;
   for(bool endLineSearch=false; !endLineSearch; lineSearchSteps++) {
     if(!o.allowOverstep) if(alpha>1.) alpha=1.;
     if(alphaHiLimit>0. && alpha>alphaHiLimit) alpha=alphaHiLimit;
-    y = x + alpha*Delta;
-    double timeBefore = rai::timerStart();
-    fy = f(gy, Hy, y);  evals++;
-    timeEval += rai::timerRead(true, timeBefore);
-    if(additionalRegularizer) fy += scalarProduct(y,(*additionalRegularizer)*vectorShaped(y));
+    //the model rejects step sizes without evaluating f: beyond where it failed before, and where it predicts too little decrease
+    if(modelValid) {
+      double alphaMax = alphaModelLimit;
+      if(modelRadius>0. && (alphaMax<0. || modelRadius/maxDelta<alphaMax)) alphaMax = modelRadius/maxDelta;
+      if(alphaMax>0. && alpha>alphaMax) {
+        alpha = alphaMax;
+        modelRejects++;
+        if(o.verbose>1) cout <<" \tmodelClip alpha=" <<std::setw(11) <<alpha <<flush;
+      }
+    }
+    double timeBefore = rai::profileClock();
+    if(fCopies.N>1) {
+      evalCandidates(y, fy, gy, Hy, alpha, Delta, gDelta);
+    } else {
+      y = x + alpha*Delta;
+      fy = f(gy, Hy, y);  evals++;
+      if(additionalRegularizer) fy += scalarProduct(y,(*additionalRegularizer)*vectorShaped(y));
+    }
+    timeEval += rai::profileClock()-timeBefore;
+    //adapt the region of trust in the model from the actual vs. the predicted decrease
+    if(modelValid) {
+      double predicted = -(alpha*gDelta + .5*alpha*alpha*DHD);
+      double rho = (predicted>0. ? (fx-fy)/predicted : 1.);
+      if(!(rho>=.25)) modelRadius = .5*alpha*maxDelta;
+      else if(rho>.75 && modelRadius>0. && alpha*maxDelta>=.5*modelRadius) modelRadius = 2.*alpha*maxDelta;
+    }
     if(o.verbose>5) cout <<" \tprobing y=" <<y;
     if(o.verbose>1) cout <<" \tevals=" <<std::setw(4) <<evals <<" \talpha=" <<std::setw(11) <<alpha <<" \tf(y)=" <<fy <<flush;
-    bool wolfe = (fy <= fx + o.wolfe*alpha*scalarProduct(Delta,gx));
+    bool wolfe = (fy <= fx + o.wolfe*alpha*gDelta);
 //    if(rootFinding) wolfe=true;
     if(fy==fy && (wolfe || o.nonStrictSteps==-1 || o.nonStrictSteps>(int)its)) { //fy==fy is for NAN?
       //accept new point
@@ -195,6 +239,8 @@ OptNewton::StopCriterion OptNewton::step() {
       if(alpha<alphaLoLimit) endLineSearch=true;
     }
   }
+  rai::profileTime("Newton/lineSearch", rai::profileClock()-time);
+  rai::profileCount("Newton/lineSearchEvals", evals-evalsBefore);
   
   if(logFile){
     (*logFile) <<"{ newton: " <<its <<", evaluations: " <<evals <<", f_x: " <<fx <<", alpha: " <<alpha;
@@ -217,6 +263,38 @@ OptNewton::StopCriterion OptNewton::step() {
   return stopCriterion=stopNone;
 }
 
+void OptNewton::setCandidateFunctions(const std::function<ScalarFunction()>& factory, uint n) {
+  fCopies.clear();
+  if(n>1) for(uint k=0; k<n; k++) fCopies.append(factory());
+}
+
+void OptNewton::evalCandidates(arr& y, double& fy, arr& gy, arr& Hy, double& alpha, const arr& Delta, double gDelta) {
+  uint K = fCopies.N;
+  arr alphas(K), fys(K);
+  arrA ys(K), gys(K), Hys(K);
+  for(uint k=0; k<K; k++) {
+    alphas(k) = alpha*pow(o.stepDec, k);
+    ys(k) = x + alphas(k)*Delta;
+  }
+  parallelFor(K, [this, &fys, &gys, &Hys, &ys](uint k) { fys(k) = fCopies(k)(gys(k), Hys(k), ys(k)); }, K);
+  evals += K;
+  if(additionalRegularizer) for(uint k=0; k<K; k++) fys(k) += scalarProduct(ys(k),(*additionalRegularizer)*vectorShaped(ys(k)));
+
+  //the lowest candidate that fulfills the Wolfe condition; otherwise the smallest step (or the largest in the non-strict phase)
+  int best=-1;
+  for(uint k=0; k<K; k++) {
+    bool wolfe = (fys(k) <= fx + o.wolfe*alphas(k)*gDelta);
+    if(fys(k)==fys(k) && wolfe && (best<0 || fys(k)<fys(best))) best=k;
+  }
+  if(best<0) best = (o.nonStrictSteps==-1 || o.nonStrictSteps>(int)its) ? 0 : K-1;
+
+  alpha = alphas(best);
+  y = ys(best);
+  fy = fys(best);
+  gy = gys(best);
+  Hy = Hys(best);
+}
+
 OptNewton::~OptNewton() {
   if(o.fmin_return) *o.fmin_return=fx;
 #ifndef RAI_MSVC
@@ -226,6 +304,7 @@ OptNewton::~OptNewton() {
 }
 
 OptNewton::StopCriterion OptNewton::run(uint maxIt) {
+  rai::ArrayPoolScope pool; //keeps the recycled memory across steps
   numTinySteps=0;
   for(uint i=0; i<maxIt; i++) {
     step();
@@ -18,12 +18,14 @@ struct OptNewton {
   ScalarFunction f;
   OptOptions o;
   arr *additionalRegularizer=0;
+  rai::Array<ScalarFunction> fCopies; ///< independent instances of f (see setCandidateFunctions): the line search then evaluates fCopies.N step sizes concurrently
   
   enum StopCriterion { stopNone=0, stopCrit1, stopCrit2, stopCritEvals, stopStepFailed };
   double fx;
   arr gx, Hx;
   double alpha, beta;
-  uint its=0, evals=0, numTinySteps=0;
+  uint its=0, evals=0, numTinySteps=0, modelRejects=0;
+  double modelRadius=-1.; ///< step length (max-norm) beyond which the quadratic model proved unreliable (<0: no restriction; reset by reinit)
   StopCriterion stopCriterion;
   arr bound_lo, bound_hi;
   bool rootFinding=false;
@@ -35,4 +37,8 @@ struct OptNewton {
   StopCriterion step();
   StopCriterion run(uint maxIt = 1000);
   void reinit(const arr& _x);
+  /// creates n>1 instances of f (e.g., each on its own problem copy) to evaluate n step sizes concurrently in the line search;
+  /// f itself is then not evaluated at the accepted points
+  void setCandidateFunctions(const std::function<ScalarFunction()>& factory, uint n);
+  void evalCandidates(arr& y, double& fy, arr& gy, arr& Hy, double& alpha, const arr& Delta, double gDelta); ///< evaluates alpha*stepDec^k, k<fCopies.N; returns the best
 };
@@ -73,6 +73,7 @@ OptOptions::OptOptions() {
   wolfe     = rai::getParameter<double>("opt/wolfe", .01);
   nonStrictSteps= rai::getParameter<uint> ("opt/nonStrictSteps", 0);
   allowOverstep= rai::getParameter<bool> ("opt/allowOverstep", false);
+  modelRejection= rai::getParameter<bool> ("opt/modelRejection", false);
   constrainedMethod = (ConstrainedMethodType)rai::getParameter<int>("opt/constrainedMethod", augmentedLag);
   muInit = rai::getParameter<double>("opt/muInit", 1.);
   muLBInit = rai::getParameter<double>("opt/muLBInit", 1.);
@@ -96,6 +97,7 @@ void OptOptions::write(std::ostream& os) const {
   WRT(dampingDec);
   WRT(nonStrictSteps);
   WRT(allowOverstep);
+  WRT(modelRejection);
   WRT(constrainedMethod);
   WRT(aulaMuInc);
 #undef WRT
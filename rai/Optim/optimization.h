@@ -104,6 +104,7 @@ struct OptOptions {
   double wolfe;
   int nonStrictSteps; //# of non-strict iterations
   bool allowOverstep;
+  bool modelRejection; //reject line search step sizes, without evaluating them, where the quadratic (Gauss-Newton) model predicts the Wolfe condition to fail or was found unreliable before
   ConstrainedMethodType constrainedMethod;
   double muInit, muLBInit;
   double aulaMuInc;
@@ -7,6 +7,7 @@
     --------------------------------------------------------------  */
 
 #include <unordered_set>
+#include <unordered_map>
 #include "filter.h"
 #include <Control/taskControl.h>
 #include <Kin/frame.h>
@@ -16,6 +17,7 @@ Filter::Filter()
     percepts_input(this, true), //listens!!
     percepts_filtered(this),
     modelWorld(this) {
+  distance_threshold = rai::getParameter<double>("Filter/distanceThreshold", distance_threshold);
   threadOpen();
 }
 
@@ -24,7 +26,6 @@ Filter::~Filter() {
 }
 
 void Filter::open() {
-  Var<rai::KinematicWorld> modelWorld(this, "modelWorld");
   modelWorld.readAccess();
   for(rai::Frame *b:modelWorld().frames) {
     if(b->ats["percept"]) {
@@ -60,104 +61,82 @@ void Filter::step() {
     return;
   }
   
-  percepts_input.writeAccess();
-  percepts_filtered.writeAccess();
+  //-- copy out the inputs (clearing the FIFO) and the database list; the association runs unlocked
+  PerceptL inputs, database;
+  {
+    auto in = percepts_input.set();
+    inputs = in();
+    in().clear();
+  }
+  
+  // If empty inputs, do nothing.
+  if(!inputs.N) return;
   
-  if(verbose>0) cout <<"FILTER: #inputs=" <<percepts_input().N <<" #database=" <<percepts_filtered().N <<endl;
+  database = percepts_filtered.get();
+  
+  if(verbose>0) cout <<"FILTER: #inputs=" <<inputs.N <<" #database=" <<database.N <<endl;
   if(verbose>1) {
     cout <<"INPUTS:" <<endl;
-    for(PerceptPtr& p:percepts_input()) cout <<(*p) <<endl;
+    for(PerceptPtr& p:inputs) cout <<(*p) <<endl;
     cout <<"DATABASE:" <<endl;
-    for(PerceptPtr& p:percepts_filtered()) cout <<(*p) <<endl;
+    for(PerceptPtr& p:database) cout <<(*p) <<endl;
   }
   
-  // If empty inputs, do nothing.
-  if(percepts_input().N == 0 && percepts_input().N == 0) {
-    percepts_filtered.deAccess();
-    percepts_input.deAccess();
-    return;
-  }
+  //-- step 1: compute gated matches within types
+  rai::Array<PerceptL> input_ofType(Percept::Type::PT_end+1), database_ofType(Percept::Type::PT_end+1);
+  for(PerceptPtr& p : inputs)   input_ofType(p->type).append(p);
+  for(PerceptPtr& p : database) database_ofType(p->type).append(p);
   
-  PerceptL newCreations;
-  
-  //-- step 1: discount precision of old percepts
-  // in forward models, the variance of two Gaussians is ADDED -> precision is 1/variance
-  for(PerceptPtr& p:percepts_filtered()) p->precision = 1./(1./p->precision + 1./precision_transition);
+  PerceptL matchedInputs, matchedObjects, unmatchedInputs;
+  for(uint t=0; t<input_ofType.N; t++) {
+    if(!input_ofType(t).N) continue;
+    intA match = associate(input_ofType(t), database_ofType(t));
+    for(uint i=0; i<match.N; i++) {
+      if(match(i)<0) unmatchedInputs.append(input_ofType(t)(i));
+      else { matchedInputs.append(input_ofType(t)(i)); matchedObjects.append(database_ofType(t)(match(i))); }
+    }
+  }
   
-  //-- step 2: compute matches within types and fuse
-  // For each type of inputs, run the matching
-  for(int t=0; t<=Percept::Type::PT_end; t++) {
-    Percept::Type type = Percept::Type(t);
-    //collect input and database percepts of given type
-    PerceptL input_ofType, database_ofType;
-    for(PerceptPtr& p : percepts_input())     if(p->type==type)  input_ofType.append(p);
-    for(PerceptPtr& p : percepts_filtered())  if(p->type==type)  database_ofType.append(p);
-    
-    //no percepts at all of this type..
-    if(!input_ofType.N && !database_ofType.N) continue;
+  //-- merge in
+  {
+    auto filtered = percepts_filtered.set();
     
-    //create bipartite costs
-    costs = createCostMatrix(input_ofType, database_ofType);
+    //-- step 2: discount precision of old percepts
+    // in forward models, the variance of two Gaussians is ADDED -> precision is 1/variance
+    for(PerceptPtr& p:filtered()) p->precision = 1./(1./p->precision + 1./precision_transition);
     
-    //run Hungarian algorithm
-    Hungarian ha(costs);
-    
-#if 0
-    // Now we have the optimal matching. Assign values.
-    PerceptL assignedObjects = assign(input_ofType, database_ofType, ha);
-    filtered.append(assignedObjects);
-#else
-    for(uint i=0; i<input_ofType.N; i++) {
-      PerceptPtr& perc = input_ofType(i);
-      int j=ha.getMatch_row(i);
-      if(j>=(int)database_ofType.N) j=-1;
-      if(j==-1) { //nothing to merge with
-        if(createNewPercepts) { //add this percept as a new object to the database
-          perc->id = nextId++;
-          perc->precision = 1.;
-          newCreations.append(perc);
-        } else {
-          perc->id = 0; //will be deleted
-        }
+    //-- step 3: fuse matches; unmatched inputs become new objects or are dropped
+    //   (the database may have changed while associating: a match that was removed meanwhile is unmatched)
+    std::unordered_set<Percept*> current;
+    for(PerceptPtr& p:filtered()) current.insert(p.get());
+    for(uint i=0; i<matchedInputs.N; i++) {
+      if(!current.count(matchedObjects(i).get())) { unmatchedInputs.append(matchedInputs(i)); continue; }
+      matchedInputs(i)->id = matchedObjects(i)->id;
+      matchedObjects(i)->fuse(matchedInputs(i));
+    }
+    PerceptL newCreations;
+    for(PerceptPtr& perc:unmatchedInputs) {
+      if(createNewPercepts) { //add this percept as a new object to the database
+        perc->id = nextId++;
+        perc->precision = 1.;
+        newCreations.append(perc);
       } else {
-        PerceptPtr& obj = database_ofType(j);
-        perc->id = obj->id;
-        obj->fuse(perc);
+        perc->id = 0; //will be deleted
       }
     }
-#endif
-  }
-  
-  //-- step 3: remove all database objects with too low precision and no body match; and append new creations
-  for(uint i=percepts_filtered().N; i--;) {
-    PerceptPtr& p = percepts_filtered()(i);
-    if(p->precision<precision_threshold && p->bodyId>=0) {
-      percepts_filtered().remove(i);
+    
+    //-- step 4: remove all database objects with too low precision and no body match; and append new creations
+    for(uint i=filtered().N; i--;) {
+      PerceptPtr& p = filtered()(i);
+      if(p->precision<precision_threshold && p->bodyId>=0) {
+        filtered().remove(i);
+      }
     }
+    filtered().append(newCreations);
+    database = filtered();
   }
-  percepts_filtered().append(newCreations);
-  newCreations.clear();
-  
-  //-- step 4: clean up remaining percepts
-  percepts_input().clear();
   
-#if 0
-  //-- delete objects in percepts and database that are not filtered
-  for(Percept* p : percepts_input()) {
-    if(!filtered.contains(p))
-      delete p;
-  }
-  percepts_input().clear();
-  
-  for(Percept* p : percepts_filtered()) {
-    if(!filtered.contains(p))
-      delete p;
-  }
-  percepts_filtered().clear();
-  percepts_filtered() = filtered;
-#endif
-  
-  //-- step 5: sync with modelWorld using inverse kinematics
+  //-- step 5: sync with modelWorld using inverse kinematics (on the database list copied above)
   modelWorld.writeAccess();
   modelWorld->selectJointsByName({"S1"});
 
@@ -166,7 +145,7 @@ void Filter::step() {
   arr q=modelWorld().q;
   
   // create task costs on the modelWorld for each percept
-  for(PerceptPtr& p:percepts_filtered()) {
+  for(PerceptPtr& p:database) {
     if(p->bodyId>=0) {
       rai::Frame *b = modelWorld->frames(p->bodyId);
       if(p->type==Percept::PT_box) {
@@ -210,11 +189,82 @@ void Filter::step() {
   
   if(verbose>1) {
     cout <<"AFTER FILTER: DATABASE:" <<endl;
-    for(PerceptPtr& p:percepts_filtered()) cout <<(*p) <<endl;
+    for(PerceptPtr& p:database) cout <<(*p) <<endl;
   }
+}
+
+intA Filter::associate(const PerceptL& inputs, const PerceptL& database) {
+  intA match(inputs.N);
+  match = -1;
+  if(!inputs.N || !database.N) return match;
   
-  percepts_filtered.deAccess();
-  percepts_input.deAccess();
+  //-- spatial hash of the database on a grid of cell size distance_threshold: an input can only be
+  //   gated with database percepts in its own or one of the 26 neighboring cells
+  double gate = distance_threshold;
+  auto cellKey = [](int64_t x, int64_t y, int64_t z) -> uint64_t {
+    return ((uint64_t)(x&0x1fffff)<<42) | ((uint64_t)(y&0x1fffff)<<21) | (uint64_t)(z&0x1fffff);
+  };
+  auto cellOf = [gate](const rai::Vector& x, int64_t* c) {
+    c[0]=::floor(x.x/gate);  c[1]=::floor(x.y/gate);  c[2]=::floor(x.z/gate);
+  };
+  std::unordered_map<uint64_t, int> cells; //cell -> last database percept in that cell
+  intA next(database.N); //list of further database percepts in the same cell
+  for(uint j=0; j<database.N; j++) {
+    int64_t c[3];
+    cellOf(database(j)->matchingPosition(), c);
+    auto ins = cells.emplace(cellKey(c[0], c[1], c[2]), j);
+    next(j) = ins.second ? -1 : ins.first->second;
+    ins.first->second = j;
+  }
+  
+  //-- candidate pairs within the gate, and connected components of this bipartite graph (union-find;
+  //   inputs are nodes 0..inputs.N-1, database percepts follow)
+  uintA edges;
+  arr edgeCosts;
+  uintA root(inputs.N+database.N);
+  for(uint k=0; k<root.N; k++) root(k)=k;
+  auto find = [&root](uint k) { while(root(k)!=k) k = root(k) = root(root(k)); return k; };
+  for(uint i=0; i<inputs.N; i++) {
+    int64_t c[3];
+    cellOf(inputs(i)->matchingPosition(), c);
+    for(int64_t dx=-1; dx<=1; dx++) for(int64_t dy=-1; dy<=1; dy++) for(int64_t dz=-1; dz<=1; dz++) {
+      auto it = cells.find(cellKey(c[0]+dx, c[1]+dy, c[2]+dz));
+      if(it==cells.end()) continue;
+      for(int j=it->second; j>=0; j=next(j)) {
+        double cost = inputs(i)->idMatchingCost(*database(j));
+        if(cost<0. || cost>=gate) continue;
+        edges.append(i);  edges.append(j);
+        edgeCosts.append(cost);
+        root(find(i)) = find(inputs.N+j);
+      }
+    }
+  }
+  edges.reshape(edgeCosts.N, 2);
+  
+  //-- optimal assignment within each component; leaving a percept unassigned costs the gate
+  intA compOf(root.N);
+  compOf = -1;
+  rai::Array<uintA> compEdges;
+  for(uint e=0; e<edgeCosts.N; e++) {
+    uint r = find(edges(e, 0));
+    if(compOf(r)<0) { compOf(r)=compEdges.N; compEdges.append(uintA()); }
+    compEdges(compOf(r)).append(e);
+  }
+  for(uintA& E:compEdges) {
+    if(E.N==1) { match(edges(E(0), 0)) = edges(E(0), 1); continue; }
+    uintA I, J;
+    for(uint e:E) { I.setAppendInSorted(edges(e, 0)); J.setAppendInSorted(edges(e, 1)); }
+    uint dim = std::max(I.N, J.N);
+    arr C(dim, dim);
+    C = gate;
+    for(uint e:E) C(I.findValue(edges(e, 0)), J.findValue(edges(e, 1))) = edgeCosts(e);
+    Hungarian ha(C);
+    for(uint i=0; i<I.N; i++) {
+      uint j = ha.getMatch_row(i);
+      if(j<J.N && C(i, j)<gate) match(I(i)) = J(j);
+    }
+  }
+  return match;
 }
 
 PerceptL Filter::assign(const PerceptL& inputs, const PerceptL& database, const Hungarian& ha) {
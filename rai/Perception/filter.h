@@ -14,7 +14,8 @@
 #include <Algo/hungarian.h>
 #include "percept.h"
 
-/// clears the perceptual inputs (which is a FIFO) and merges these into the filtered percepts
+/// clears the perceptual inputs (which is a FIFO) and merges these into the filtered percepts;
+/// inputs are only associated with database percepts of same type within distance_threshold
 struct Filter : Thread {
   Var<PerceptL> percepts_input;
   Var<PerceptL> percepts_filtered;
@@ -34,13 +35,14 @@ private:
   double relevance_decay_factor = 0.99;
   double precision_transition = 20.;
   double precision_threshold = 0.25;
-  double distance_threshold = 0.5;
+  double distance_threshold = 0.5; ///< gate of the association (parameter Filter/distanceThreshold)
   
   uint nextId = 1;
   
   arr costs;
   
   arr createCostMatrix(const PerceptL& inputs, const PerceptL& database);
+  intA associate(const PerceptL& inputs, const PerceptL& database); ///< gated assignment: for each input the index of its database match, or -1
   PerceptL assign(const PerceptL& inputs, const PerceptL& database, const Hungarian& ha);
   
   int revision = -1;
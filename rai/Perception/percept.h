@@ -33,6 +33,7 @@ struct Percept : GLDrawer {
   
   virtual void syncWith(rai::KinematicWorld& K) = 0;
   virtual double idMatchingCost(const Percept& other);
+  virtual rai::Vector matchingPosition() const { return pose.pos; } ///< for spatial gating: idMatchingCost must not be below the distance of these
   virtual double fuse(PerceptPtr& other);
   virtual void write(ostream& os) const;
   virtual void glDraw(OpenGL&) { NIY }
@@ -57,6 +58,7 @@ struct PercCluster : Percept {
   
   virtual void syncWith(rai::KinematicWorld& K);
   virtual double idMatchingCost(const Percept& other);
+  virtual rai::Vector matchingPosition() const { return pose * rai::Vector(mean); }
   virtual void write(ostream& os) const;
   virtual Percept* newClone() const { return new PercCluster(*this); }
 };
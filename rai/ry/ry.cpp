@@ -948,6 +948,19 @@ py::arg("featureSymbol"),
     skeleton2Bound(*self.komo, boundType, S, self.komo->world, self.komo->world, collisions);
   } )
 
+  .def("retarget", [](ry::RyKOMO& self, uint objective, const std::vector<double>& target, const std::vector<double> scale){
+    CHECK_LE(objective+1, self.komo->objectives.N, "objective index out of range");
+    arr _target, _scale;
+    if(target.size()) _target=conv_stdvec2arr(target);
+    if(scale.size()) _scale=conv_stdvec2arr(scale);
+    self.komo->retarget(self.komo->objectives(objective), target.size()?_target:NoArr, scale.size()?_scale:NoArr);
+  },
+  "change target and/or scale of the i-th added objective in place; optimize(False) then reuses the problem structure\
+  (e.g., for IK queries toward a moving goal at high frequency)",
+      py::arg("objective"),
+      py::arg("target")=std::vector<double>(),
+      py::arg("scale")=std::vector<double>() )
+
   //-- run
 
   .def("optimize", [](ry::RyKOMO& self, bool reinitialize_randomly){
@@ -1350,6 +1363,8 @@ py::arg("featureSymbol"),
 
       ENUMVAL(FS,transAccelerations)
       ENUMVAL(FS,transVelocities)
+
+      ENUMVAL(FS,sweptDistance)
       .export_values();
 
 #undef ENUMVAL
@@ -44,6 +44,16 @@ void TEST(ANNIncremental) {
       //rai::wait();
     }
   }
+
+  //batch queries run concurrently and must agree with single queries
+  arr qs(100,dim), dists, d;
+  intA idx2;
+  rndUniform(qs,0.,1.,false);
+  ann.getkNN_batch(dists, idx2, qs, 10);
+  for(uint i=0;i<qs.d0;i++){
+    ann.getkNN(d, idx, qs[i], 10);
+    CHECK_ZERO(absMax(d-dists[i]), 1e-10, "batch query differs");
+  }
 }
 
 /*void TEST(ANNregression){
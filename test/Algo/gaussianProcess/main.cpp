@@ -0,0 +1,101 @@
+#include <Core/util.h>
+#include <Algo/gaussianProcess.h>
+
+/// the factor of gp compared to a full recomputation on the same data
+double factorError(const GaussianProcess& gp){
+  GaussianProcess full(gp);
+  full.recompute();
+  CHECK_EQ(full.L.N, gp.L.N, "");
+  return maxDiff(full.L, gp.L) + maxDiff(full.GinvY, gp.GinvY);
+}
+
+void TEST(Incremental){
+  GaussKernelParams P(1., .3, .1);
+  GaussianProcess gp;
+  gp.setGaussKernelGP(&P, .5);
+  gp.obsVar = .01;
+
+  arr x(2);
+  for(uint i=0;i<30;i++){
+    rndUniform(x, -1., 1., false);
+    gp.appendObservation(x, sin(3.*x(0))*x(1));
+    CHECK_ZERO(factorError(gp), 1e-8, "append at " <<i);
+  }
+
+  for(uint r : {0u, 13u, 27u}){
+    gp.removeObservation(r);
+    CHECK_ZERO(factorError(gp), 1e-8, "remove " <<r);
+  }
+
+  //push/pop restore the previous predictions
+  arr q = {.2, -.3};
+  double y0, s0, y1, s1;
+  gp.evaluate(q, y0, s0);
+  gp.push(q, 1.);
+  gp.pop();
+  gp.evaluate(q, y1, s1);
+  CHECK_ZERO(y1-y0, 1e-8, "");
+  CHECK_ZERO(s1-s0, 1e-8, "");
+}
+
+void TEST(Window){
+  GaussKernelParams P(1., .3, .1);
+  GaussianProcess gp;
+  gp.setGaussKernelGP(&P, 0.);
+  gp.maxData = 10;
+
+  arr x(1), X;
+  for(uint i=0;i<25;i++){
+    rndUniform(x, -1., 1., false);
+    X.append(x);
+    gp.appendObservation(x, cos(4.*x(0)));
+    CHECK_EQ(gp.Y.N, (i<10?i+1:10), "");
+    CHECK_ZERO(factorError(gp), 1e-8, "window append at " <<i);
+  }
+  X.reshape(25, 1);
+  CHECK_ZERO(maxDiff(gp.X, X.sub(15, -1, 0, -1)), 0., "the window must hold the latest data");
+}
+
+void TEST(Rebuild){
+  GaussKernelParams P(1., .3, .1);
+  GaussianProcess gp;
+  gp.setGaussKernelGP(&P, 0.);
+
+  //data set directly: the factor is stale and gets rebuilt on the next append
+  gp.X = randn(5, 1);
+  gp.Y = randn(5);
+  gp.appendObservation(ARR(.1), 1.);
+  CHECK_ZERO(factorError(gp), 1e-8, "");
+
+  //derivative data: appending and removing rebuild the factor
+  gp.appendDerivativeObservation(ARR(.3), 2., 0);
+  gp.appendObservation(ARR(-.2), 0.);
+  CHECK_EQ(gp.GinvY.N, 8, "");
+  CHECK_ZERO(factorError(gp), 1e-8, "");
+  gp.removeObservation(2);
+  CHECK_EQ(gp.GinvY.N, 7, "");
+  CHECK_ZERO(factorError(gp), 1e-8, "");
+
+  //duplicate inputs without observation noise: a singular Gram matrix is an error, not inf/nan
+  GaussianProcess noiseless;
+  noiseless.setGaussKernelGP(&P, 0.);
+  noiseless.obsVar = 0.;
+  noiseless.appendObservation(ARR(.5), 1.);
+  bool caught=false;
+  try{
+    noiseless.appendObservation(ARR(.5), 1.);
+  }catch(...){
+    caught=true;
+  }
+  CHECK(caught, "the singular factor was not detected");
+}
+
+int MAIN(int argc,char** argv){
+  rai::initCmdLine(argc, argv);
+
+  testIncremental();
+  testWindow();
+  testRebuild();
+
+  return 0;
+}
@@ -184,10 +184,38 @@ void TEST(Path){
 
 }
 
+void TEST(ActiveCoeffs){
+  for(uint degree:{1u, 2u, 3u, 5u, 9u}){ //degree 9 exceeds the local recursion and falls back to getCoeffs
+    arr X(14, 2);
+    rndUniform(X, -1, 1, false);
+    rai::Spline S(0, X, degree);
+    uint K=X.d0-1;
+    arr b(degree+1), db(degree+1), ddb(degree+1), f(2), fDot(2), fDDot(2);
+    for(double t=-.2; t<=1.2; t+=.01){ //also outside the knots
+      int first = S.getActiveCoeffs(t, b.p, db.p, ddb.p);
+      arr B=zeros(K+1), dB=zeros(K+1), ddB=zeros(K+1);
+      for(uint i=0; i<=degree; i++){
+        int k=first+i;
+        if(k<0 || k>(int)K) continue;
+        B(k)=b(i);  dB(k)=db(i);  ddB(k)=ddb(i);
+      }
+      CHECK_ZERO(maxDiff(B, S.getCoeffs(t, K, 0)), 1e-10, "degree " <<degree <<" t=" <<t);
+      CHECK_ZERO(maxDiff(dB, S.getCoeffs(t, K, 1)), 1e-8, "degree " <<degree <<" t=" <<t);
+      CHECK_ZERO(maxDiff(ddB, S.getCoeffs(t, K, 2)), 1e-6, "degree " <<degree <<" t=" <<t);
+
+      S.eval(f.p, fDot.p, fDDot.p, t);
+      CHECK_ZERO(maxDiff(f, ~S.getCoeffs(t, K, 0)*X), 1e-10, "");
+      CHECK_ZERO(maxDiff(fDot, ~S.getCoeffs(t, K, 1)*X), 1e-8, "");
+      CHECK_ZERO(maxDiff(fDDot, ~S.getCoeffs(t, K, 2)*X), 1e-6, "");
+    }
+  }
+}
+
 int MAIN(int argc,char** argv){
   rai::initCmdLine(argc, argv);
 
 //  testBSpline();
+  testActiveCoeffs();
   testBSpline2();
 //  testPath();
 
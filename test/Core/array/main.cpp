@@ -223,6 +223,82 @@ void TEST(StdVectorCompat) {
 
 //===========================================================================
 
+void TEST(MoveSemantics) {
+  arr A = randn(4, 3), B = A;
+  double *p = A.p;
+  arr C(std::move(A)); //takes over the memory
+  CHECK_EQ(C.p, p, "");
+  CHECK(!A.N && !A.p, "");
+  C = std::move(C + B); //move assignment
+  CHECK_EQ(C.d1, 3, "");
+
+  //assignments into and from references copy
+  arr M = zeros(3, 3);
+  M[1]() = arr{1., 2., 3.};
+  CHECK_EQ(M(1, 2), 3., "");
+  arr r;
+  r = M[1];
+  r(0) = 10.;
+  CHECK_EQ(M(1, 0), 1., "");
+
+  //special payloads move along
+  arr S;
+  S.sparse().resize(3, 3, 0);
+  S.sparse().addEntry(0, 1) = 2.;
+  arr S2 = std::move(S);
+  CHECK(isSparseMatrix(S2) && !S.special, "");
+  CHECK_EQ(&S2.sparse().Z, &S2, "");
+  CHECK_EQ(unpack(S2)(0, 1), 2., "");
+}
+
+//===========================================================================
+
+void TEST(SmallArrays) {
+  arr33 R;
+  CHECK_EQ(R.nd, 2, "");
+  CHECK_ZERO(sumOfSqr(R), 0., "");
+  double *buffer=R.p;
+  R = eye(3);
+  R *= 2.;
+  CHECK_EQ(R.p, buffer, "assignment should stay in the inline buffer");
+  arr3 x = {1., 2., 3.};
+  arr y = R*x;
+  CHECK_ZERO(maxDiff(y, 2.*x), 1e-10, "");
+
+  rai::SmallArray<double, 4> s;
+  for(uint i=0; i<10; i++) s.append((double)i); //spills to the heap after 4
+  CHECK_EQ(s.N, 10, "");
+  CHECK_EQ(s(7), 7., "");
+  rai::SmallArray<double, 4> t;
+  t.resize(3);
+  t.clear();
+  t.resize(2);
+  CHECK_EQ(t.p, t.buffer, "a cleared small array keeps its inline buffer");
+
+  arrA A(3);
+  A(0) = arr3{1., 0., 0.}; //moving from a SmallArray copies
+  CHECK_EQ(A(0).N, 3, "");
+}
+
+//===========================================================================
+
+void TEST(ArrayPool) {
+  arr x;
+  {
+    rai::ArrayPoolScope pool;
+    arr a = randn(10, 10);
+    double *p = a.p;
+    a.clear();
+    arr b = randn(10, 10);
+    CHECK_EQ(b.p, p, "freed memory should be recycled within the scope");
+    x = 2.*b; //x outlives the scope
+  }
+  x += 1.;
+  CHECK_EQ(x.N, 100, "");
+}
+
+//===========================================================================
+
 void TEST(SimpleIterators) {
   // This test shows how to use the iterators
 
@@ -866,6 +942,9 @@ int MAIN(int argc, char **argv){
   testSorted();
   testRowsAndColumsAccess();
   testStdVectorCompat();
+  testMoveSemantics();
+  testSmallArrays();
+  testArrayPool();
   testMatlab();
   testException();
 //  testMemoryBound();
@@ -1,4 +1,5 @@
 #include <Core/graph.h>
+#include <thread>
 
 //const char *filename="/home/mtoussai/git/3rdHand/documents/USTT/14-meeting3TUD/box.g";
 const char *filename=NULL;
@@ -141,6 +142,56 @@ void TEST(Dot){
 
 //===========================================================================
 
+void TEST(KeyIndex){
+  //findNode* on a large (key-indexed) graph must return the same nodes in the same order as a scan
+  Graph G;
+  auto check = [&G](const StringA& keys) {
+    NodeL scan;
+    for(Node *n:G) if(n->matches(keys)) scan.append(n);
+    CHECK(G.findNodes(keys)==scan, "key index lookup differs from scan for " <<keys);
+    CHECK_EQ(G.findNode(keys), (scan.N?scan.first():NULL), "");
+    NodeL typed;
+    for(Node *n:scan) if(n->isOfType<double>()) typed.append(n);
+    CHECK(G.findNodesOfType(typeid(double), keys)==typed, "");
+  };
+  for(uint k=0;k<1000;k++){
+    uint r=rnd(4);
+    if(r==0 && G.N){ //delete some node
+      delete G.rndElem();
+    }else if(r==1 && G.N){ //change the keys of a node
+      G.rndElem()->keys.last() = STRING('k' <<rnd(50));
+      G.invalidateKeyIndex();
+    }else{ //append a node, with a key set after creation
+      Node *n = (rnd.uni()<.5) ? (Node*)G.newNode<double>({STRING('k' <<rnd(50))}, {}, 1.) : (Node*)G.newNode<bool>({}, {}, true);
+      n->keys.append(STRING('x' <<rnd(5)));
+    }
+    check({STRING('k' <<rnd(50))});
+    check({STRING('k' <<rnd(50)), STRING('x' <<rnd(5))});
+  }
+  G.checkConsistency();
+
+  //a node renamed without invalidating, then deleted, must not stay in the index under its old key
+  Node *n = G.newNode<double>({"renamed"}, {}, 1.);
+  CHECK_EQ(G.findNode({"renamed"}), n, "");
+  n->keys.last() = "gone";
+  delete n;
+  CHECK(!G.findNode({"renamed"}), "");
+
+  //concurrent finds (the first of which builds the index)
+  G.invalidateKeyIndex();
+  std::thread threads[4];
+  for(auto& th:threads) th = std::thread([&G](){
+    for(uint i=0;i<1000;i++){
+      StringA keys = {STRING('k' <<i%50)};
+      Node *found = G.findNode(keys);
+      if(found) CHECK(found->matches(keys), "");
+    }
+  });
+  for(auto& th:threads) th.join();
+}
+
+//===========================================================================
+
 struct Something{
   Something(double y=0.){ x=y; }
   double x;
@@ -170,6 +221,7 @@ int MAIN(int argc, char** argv){
   testRead();
   testInit();
   testDot();
+  testKeyIndex();
 
   testManual();
 
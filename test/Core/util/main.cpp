@@ -1,7 +1,9 @@
 #include <Core/util.h>
 #include <Core/graph.h>
+#include <Core/profile.h>
 #include <math.h>
 #include <iomanip>
+#include <thread>
 
 void TEST(String){
   //-- basic IO
@@ -73,6 +75,25 @@ void TEST(Timer){
   CHECK(cpuTime>=0. && cpuTime<1.,"no cpu time measured");
 }
 
+void TEST(Profile){
+  rai::profileEnable();
+  rai::profileClear();
+  std::thread threads[4];
+  for(auto& th:threads) th = std::thread([](){
+    for(uint i=0;i<1000;i++){
+      rai::ProfileScope profile("test/", "scope");
+      rai::profileCount("test/count", 2);
+    }
+  });
+  for(auto& th:threads) th.join();
+  std::stringstream report;
+  rai::profileReport(report);
+  cout <<report.str();
+  CHECK(report.str().find("{ \"tag\": \"test/scope\", \"count\": 4000,")!=std::string::npos, "scopes of all threads need to be merged");
+  CHECK(report.str().find("{ \"tag\": \"test/count\", \"count\": 8000,")!=std::string::npos, "counts of all threads need to be merged");
+  rai::profileEnable(false);
+}
+
 void TEST(Logging){
   rai::LogObject _log("Test");
   LOG(-1) <<"HALLO";
@@ -112,6 +133,7 @@ int MAIN(int argc,char** argv){
   testString();
   testParameter();
   testTimer();
+  testProfile();
   testLogging();
   testException();
   testInotify();
@@ -0,0 +1,77 @@
+#include <Geo/broadphase.h>
+#include <Geo/geo.h>
+
+//===========================================================================
+
+/// all allowed pairs (i<j) of active objects whose world boxes overlap
+uintA bruteForcePairs(const rai::SweepAndPrune& bp){
+  uintA P;
+  for(uint i=0; i<bp.size(); i++) for(uint j=i+1; j<bp.size(); j++){
+    if(!bp.active(i) || !bp.active(j) || !bp.isAllowed(i, j)) continue;
+    bool overlap=true;
+    for(uint k=0; k<3; k++) if(bp.box(i, k)>bp.box(j, 3+k) || bp.box(j, k)>bp.box(i, 3+k)) overlap=false;
+    if(overlap) P.append(TUP(i, j));
+  }
+  return P.reshape(-1, 2);
+}
+
+/// the first nPairs rows of the buffer, sorted lexicographically
+uintA sortedPairs(const rai::SweepAndPrune& bp){
+  std::vector<std::pair<uint,uint>> V;
+  for(uint i=0; i<bp.nPairs; i++) V.push_back({bp.pairs(i, 0), bp.pairs(i, 1)});
+  std::sort(V.begin(), V.end());
+  uintA S;
+  for(auto& p:V) S.append(TUP(p.first, p.second));
+  return S.reshape(-1, 2);
+}
+
+void TEST(SweepAndPrune){
+  uint n=200;
+  rai::SweepAndPrune bp(n);
+
+  //-- objects of random size, some never activated (they have no box)
+  arr pose(n, 7);
+  for(uint i=0; i<n; i++){
+    pose[i] = cat(2.*rand(3)-1., {1., 0., 0., 0.});
+    if(i%10==9) continue;
+    arr size = .02 + .1*rand(3);
+    bp.setLocalBox(i, cat(-size, size));
+  }
+
+  //-- a random filter
+  for(uint i=0; i<n; i++) for(uint j=0; j<i; j++) bp.allowPair(i, j, rnd.uni()<.8);
+
+  uint total=0;
+  for(uint t=0; t<100; t++){
+    //drift and rotate
+    for(uint i=0; i<n; i++) if(bp.active(i)){
+      for(uint k=0; k<3; k++) pose(i, k) += .02*rnd.gauss();
+      rai::Quaternion q;
+      q.set(pose[i].p+3);
+      q.addX(.05*rnd.gauss());
+      pose(i, 3)=q.w;  pose(i, 4)=q.x;  pose(i, 5)=q.y;  pose(i, 6)=q.z;
+      bp.setPose(i, pose[i].p);
+    }
+
+    //change the filter and activate a late object during the run
+    if(t==30) for(uint i=0; i<n; i+=3) for(uint j=0; j<n; j+=7) if(i!=j) bp.allowPair(i, j, false);
+    if(t==60) for(uint i=0; i<n; i++) for(uint j=0; j<i; j++) bp.allowPair(i, j);
+    if(t==60){ bp.setLocalBox(9, {-.5, -.5, -.5, .5, .5, .5}); bp.setPose(9, pose[9].p); }
+
+    bp.step();
+    uintA P = bruteForcePairs(bp);
+    CHECK_EQ(sortedPairs(bp), P, "sweep and prune pairs differ from brute force at step " <<t);
+    total += P.d0;
+  }
+  cout <<"sweep and prune: " <<total <<" pairs over 100 steps match brute force" <<endl;
+}
+
+//===========================================================================
+
+int MAIN(int argc, char** argv){
+  rai::initCmdLine(argc, argv);
+
+  testSweepAndPrune();
+
+  return 0;
+}
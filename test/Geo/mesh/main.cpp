@@ -279,6 +279,156 @@ void TEST(SimpleImplicitSurfaces) {
 
 //===========================================================================
 
+void TEST(Binary){
+  rai::Mesh m, h, m2, h2;
+  m.setBox();
+  m.subDivide();
+  m.computeNormals();
+  m.C = {.8, .2, .2};
+  h.setTetrahedron();
+  m.writeBinary("z.rmb", &h);
+
+  CHECK(m2.readBinary("z.rmb", &h2), "");
+  CHECK_EQ(m2.V, m.V, "");
+  CHECK_EQ(m2.T, m.T, "");
+  CHECK_EQ(m2.Vn, m.Vn, "");
+  CHECK_EQ(m2.Tn, m.Tn, "");
+  CHECK_EQ(m2.C, m.C, "");
+  CHECK_EQ(h2.V, h.V, "");
+  CHECK_EQ(h2.T, h.T, "");
+
+  m.writeBinary("z.rmb");
+  CHECK(!m2.readBinary("z.rmb", &h2), "the hull was not stored");
+  CHECK(m2.readBinary("z.rmb"), "");
+  CHECK_EQ(m2.V, m.V, "");
+  CHECK_EQ(m2.T, m.T, "");
+
+  //the arrays live in the (copy-on-write) mapping until they grow
+  CHECK(m2.V.local && !m2.V.ownedMEM(), "V is not mapped");
+  m2.scale(2.);
+  rai::Mesh m3;
+  CHECK(m3.readBinary("z.rmb"), "");
+  CHECK_EQ(m3.V, m.V, "scaling the mapped mesh changed the file");
+  m2.subDivide();
+  CHECK(!m2.V.local && m2.V.d0>m.V.d0, "");
+  rai::Mesh copy = m3;
+  CHECK(!copy.V.local, "copies own their arrays");
+  m.scale(3.);
+  m.writeBinary("z.rmb"); //replaces the file: m3 keeps the old one
+  CHECK_EQ(m3.V, copy.V, "");
+  CHECK(m3.readBinary("z.rmb"), "");
+  CHECK_EQ(m3.V, m.V, "");
+}
+
+//===========================================================================
+
+void TEST(Cache){
+  //uses Mesh/cacheDir, see rai.cfg
+  rai::system("rm -f z.meshCache/*.rmb");
+  rai::Mesh m, m2;
+  m.setBox();
+  m.subDivide();
+  m.translate(.1, .2, .3);
+  m.writeTriFile("z.tri");
+  m2.read(FILE("z.tri"), "tri", "z.tri"); //parses, writes the cache entry
+  CHECK(!m2.V.local, "");
+  m2.read(FILE("z.tri"), "tri", "z.tri"); //maps the cache entry
+  CHECK(m2.V.local, "not read from the cache");
+  CHECK_EQ(m2.V.d0, m.V.d0, "");
+  CHECK_EQ(m2.T, m.T, "");
+
+  //hulls are stored keyed by the vertices, and reused
+  rai::Mesh h = m2;
+  CHECK(!h.readCachedHull(), "");
+  m2.makeConvexHull();
+  CHECK(h.readCachedHull(), "the hull was not cached");
+  CHECK_EQ(h.V, m2.V, "");
+  CHECK_EQ(h.T, m2.T, "");
+  h = m;
+  h.translate(0., 0., .1);
+  CHECK(!h.readCachedHull(), "other vertices share the hull");
+}
+
+//===========================================================================
+
+void TEST(FuseNearVertices){
+  rai::Mesh m;
+  m.setBox();
+  m.subDivide();
+  m.subDivide();
+  m.fuseNearVertices(1e-6); //subDivide duplicates the vertices on edges
+
+  //split all triangles apart, jittering each copy of a vertex within a tenth of the tolerance
+  double tol=1e-3;
+  rai::Mesh s;
+  s.V.resize(m.T.N, 3);
+  s.T.resize(m.T.d0, 3);
+  for(uint k=0; k<m.T.N; k++) {
+    s.V[k] = m.V[m.T.elem(k)] + .2*tol*(rand(3)-.5);
+    s.T.elem(k) = k;
+  }
+  s.fuseNearVertices(tol);
+  cout <<"#V=" <<m.V.d0 <<" split=" <<m.T.N <<" fused=" <<s.V.d0 <<endl;
+  CHECK_EQ(s.V.d0, m.V.d0, "");
+  CHECK_EQ(s.T.d0, m.T.d0, "");
+
+  //each fused triangle is the original one, up to the jitter
+  for(uint i=0; i<m.T.d0; i++) for(uint j=0; j<3; j++) {
+    CHECK_LE(maxDiff(s.V[s.T(i, j)], m.V[m.T(i, j)]), .1*tol, "");
+  }
+
+  //a fused mesh stays the same
+  s = m;
+  s.fuseNearVertices(1e-6);
+  CHECK_EQ(s.V, m.V, "");
+  CHECK_EQ(s.T, m.T, "");
+}
+
+//===========================================================================
+
+void TEST(Normals){
+  rai::Mesh m;
+  m.setBox();
+  for(uint k=0; k<6; k++) m.subDivide(); //large enough to compute in parallel
+  m.computeNormals();
+
+  //sequential reference
+  arr Tn(m.T.d0, 3), Vn(m.V.d0, 3);
+  Vn.setZero();
+  for(uint i=0; i<m.T.d0; i++) {
+    arr a=m.V[m.T(i, 0)], b=m.V[m.T(i, 1)], c=m.V[m.T(i, 2)];
+    arr n = crossProduct(b-a, c-a);
+    Tn[i] = n/length(n);
+    for(uint j=0; j<3; j++) Vn[m.T(i, j)] += Tn[i];
+  }
+  for(uint i=0; i<m.V.d0; i++) Vn[i] /= length(Vn[i]);
+
+  CHECK_ZERO(maxDiff(m.Tn, Tn), 1e-10, "");
+  CHECK_ZERO(maxDiff(m.Vn, Vn), 1e-10, "");
+}
+
+//===========================================================================
+
+void TEST(HullPrefilter){
+  //enough points to take the prefiltered path
+  arr V = randn(30000, 3);
+  uintA T, T2;
+  arr H = getHull(V, T);
+  arr H2 = getHull(V, T2, false);
+  cout <<"#hull vertices=" <<H.d0 <<" #triangles=" <<T.d0 <<endl;
+
+  CHECK_EQ(H.d0, H2.d0, "");
+  CHECK_EQ(T.d0, T2.d0, "");
+  //same vertices, possibly in a different order
+  for(uint i=0; i<H.d0; i++) {
+    bool found=false;
+    for(uint j=0; j<H2.d0 && !found; j++) if(maxDiff(H[i], H2[j])==0.) found=true;
+    CHECK(found, "hull vertex " <<i <<" is missing in the unfiltered hull");
+  }
+}
+
+//===========================================================================
+
 int MAIN(int argc, char** argv){
   rai::initCmdLine(argc, argv);
 
@@ -288,6 +438,11 @@ int MAIN(int argc, char** argv){
   testMeshes3();
   testGJK();
   testVolume();
+  testBinary();
+  testCache();
+  testFuseNearVertices();
+  testNormals();
+  testHullPrefilter();
   testDistanceFunctions();
   testDistanceFunctions2();
   testSimpleImplicitSurfaces();
@@ -119,6 +119,128 @@ void TEST(FinalPosePR2){
 
 //===========================================================================
 
+void TEST(RecedingHorizon){
+  rai::KinematicWorld K("arm.g");
+  uint n = K.getJointStateDimension();
+  KOMO komo;
+  komo.setModel(K, false);
+  komo.setPathOpt(1., 20, 5.);
+  komo.setSquaredQAccelerations();
+  komo.addObjective({.8, 1.}, OT_eq, FS_positionDiff, {"endeff", "target"}, {1e1});
+  komo.verbose=0;
+  komo.reset();
+  komo.run();
+  uint coldEvals = komo.opt->newton.evals;
+  cout <<"initial: costs=" <<komo.getCosts() <<" eq=" <<komo.getConstraintViolations() <<" evals=" <<coldEvals <<endl;
+
+  //replan at control rate: shift the window by one step and warm start from the previous solution
+  for(uint k=0;k<5;k++){
+    arr x=komo.x, dual=komo.dual;
+    komo.shift(1);
+    CHECK_EQ(komo.x.N, x.N, "");
+    CHECK_ZERO(maxDiff(komo.x({0, x.N-n-1}), x({n, x.N-1})), 1e-10, "primal warm start must be the shifted solution");
+    CHECK_EQ(komo.dual.N, dual.N, "");
+    uint kept=0;
+    for(double l:komo.dual) if(l!=0.) {
+      CHECK(dual.findValue(l)>=0, "a dual was not carried over from the previous solution");
+      kept++;
+    }
+    CHECK_GE(kept, 9, "duals of the goal features remaining in the window must be kept");
+    komo.run();
+    uint evals = komo.opt->newton.evals;
+    cout <<"shift " <<k <<": costs=" <<komo.getCosts() <<" eq=" <<komo.getConstraintViolations() <<" evals=" <<evals <<endl;
+    CHECK_LE(komo.getConstraintViolations(), .1, "");
+    CHECK_LE(evals, coldEvals, "the warm started re-solve should not need more evaluations than the cold start");
+  }
+}
+
+//===========================================================================
+
+void TEST(Retarget){
+  rai::KinematicWorld K("arm.g");
+  KOMO komo;
+  komo.setModel(K, false);
+  komo.setPathOpt(1., 10, 5.);
+  komo.setSquaredQAccelerations();
+  Objective *goal = komo.addObjective({1.}, OT_eq, FS_position, {"endeff"}, {1e1}, {.7, -.5, 1.2});
+  komo.verbose=0;
+  komo.optimize();
+  arr x0=komo.x, dual0=komo.dual;
+
+  //retarget and re-solve on the cached structure
+  arr target = {.6, -.4, 1.3};
+  uint64_t hash = komo.getStructureHash();
+  komo.retarget(goal, target);
+  CHECK_EQ(komo.getStructureHash(), hash, "retargeting must not change the structure");
+  komo.optimize(false);
+  CHECK_EQ(komo.structureHash, hash, "");
+  arr pos = komo.configurations.last()->getFrameByName("endeff")->X.pos.getArr();
+  CHECK_ZERO(maxDiff(pos, target), 1e-3, "retargeted goal not reached");
+
+  //same warm start, but the problem set up from scratch for the new target
+  KOMO fresh;
+  fresh.setModel(K, false);
+  fresh.setPathOpt(1., 10, 5.);
+  fresh.setSquaredQAccelerations();
+  fresh.addObjective({1.}, OT_eq, FS_position, {"endeff"}, {1e1}, target);
+  fresh.verbose=0;
+  fresh.reset();
+  fresh.x=x0;
+  fresh.dual=dual0;
+  fresh.run();
+  CHECK_ZERO(maxDiff(komo.x, fresh.x), 1e-10, "retarget + optimize(false) must equal a rebuilt problem");
+  cout <<"retarget -- SUCCESS" <<endl;
+}
+
+//===========================================================================
+
+void TEST(Prefix){
+  rai::KinematicWorld K("arm.g");
+  arr target1 = {.7, -.5, 1.2}, target2 = {.6, -.4, 1.3};
+  auto setup = [&K, &target1, &target2](KOMO& komo, double phases){
+    komo.setModel(K, false);
+    komo.setPathOpt(phases, 10, 5.);
+    komo.setSquaredQAccelerations();
+    komo.addObjective({1.}, OT_eq, FS_position, {"endeff"}, {1e1}, target1);
+    if(phases>1.) komo.addObjective({2.}, OT_eq, FS_position, {"endeff"}, {1e1}, target2);
+    komo.verbose=0;
+  };
+
+  //-- the prefix solves the first phase only
+  KOMO prefix;
+  setup(prefix, 1.);
+  prefix.optimize();
+
+  //-- warm start the two-phase problem from the prefix
+  KOMO komo;
+  setup(komo, 2.);
+  komo.initWithPrefix(prefix, 10);
+  for(uint t=0; t<10; t++)
+    CHECK_EQ(komo.configurations(komo.k_order+t)->getJointState(), prefix.configurations(prefix.k_order+t)->getJointState(), "shared steps must be copied");
+  for(uint t=10; t<20; t++)
+    CHECK_EQ(komo.configurations(komo.k_order+t)->getJointState(), prefix.configurations.last()->getJointState(), "the rest must hold the last shared step");
+  uint copied=0;
+  for(double l:komo.dual) if(l!=0.) {
+    CHECK(prefix.dual.findValue(l)>=0, "a dual was not carried over from the prefix");
+    copied++;
+  }
+  CHECK_GE(copied, 3, "the duals of the first goal must be copied");
+  komo.run();
+  uint warmEvals = komo.opt->newton.evals;
+
+  //-- the same problem from a cold start
+  KOMO cold;
+  setup(cold, 2.);
+  cold.optimize();
+  uint coldEvals = cold.opt->newton.evals;
+  cout <<"prefix warm start: evals=" <<warmEvals <<" (cold: " <<coldEvals <<") costs=" <<komo.getCosts() <<" (cold: " <<cold.getCosts() <<") eq=" <<komo.getConstraintViolations() <<" (cold: " <<cold.getConstraintViolations() <<")" <<endl;
+  CHECK_LE(komo.getConstraintViolations(), .1, "");
+  CHECK_LE(komo.getCosts(), cold.getCosts()+1e-2, "the warm start must not end in a worse solution");
+  CHECK_LE(warmEvals, coldEvals, "the warm start should not need more evaluations than the cold start");
+}
+
+//===========================================================================
+
 int main(int argc,char** argv){
   rai::initCmdLine(argc,argv);
 
@@ -126,6 +248,9 @@ int main(int argc,char** argv){
 
 //  testEasy();
 //  testAlign();
+  testRetarget();
+  testRecedingHorizon();
+  testPrefix();
   testPR2();
 
   return 0;
@@ -0,0 +1,58 @@
+#include <KOMO/parallelRRT.h>
+#include <Kin/kin.h>
+
+//===========================================================================
+
+void TEST(PlanPath){
+  rai::KinematicWorld K("maze.g");
+
+  rai::ParallelRRTPlanner rrt(K, .1, 4);
+  rrt.verbose = true;
+
+  arr q0 = {-.7, -.7}, qT = {.7, -.7};
+  CHECK(rrt.isFeasible(q0), "");
+  CHECK(rrt.isFeasible(qT), "");
+  CHECK(!rrt.isFeasibleEdge(q0, qT), "the wall blocks the direct path");
+
+  arr path = rrt.planPath(q0, qT, 10000);
+  cout <<"path length: " <<path.d0 <<endl;
+  CHECK(path.d0>=2, "no path found");
+  CHECK_ZERO(maxDiff(path[0], q0), 1e-10, "");
+  CHECK_ZERO(maxDiff(path[path.d0-1], qT), 1e-10, "");
+  for(uint t=1; t<path.d0; t++) CHECK(rrt.isFeasibleEdge(path[t-1], path[t]), "infeasible edge " <<t);
+
+  //the path has to pass the gap at the upper end of the wall
+  double yMax = -1.;
+  for(uint t=0; t<path.d0; t++) yMax = std::max(yMax, path(t, 1));
+  CHECK_GE(yMax, .5, "");
+
+  arr short_path = path;
+  rrt.shortcut(short_path);
+  cout <<"shortcut path length: " <<short_path.d0 <<endl;
+  CHECK_LE(short_path.d0, path.d0, "");
+  CHECK_ZERO(maxDiff(short_path[0], q0), 1e-10, "");
+  CHECK_ZERO(maxDiff(short_path[short_path.d0-1], qT), 1e-10, "");
+  for(uint t=1; t<short_path.d0; t++) CHECK(rrt.isFeasibleEdge(short_path[t-1], short_path[t]), "infeasible edge " <<t);
+
+  arrA waypoints = rrt.getWaypoints(short_path, 10);
+  CHECK_EQ(waypoints.N, 10, "");
+  CHECK_ZERO(maxDiff(waypoints.last(), qT), 1e-10, "");
+
+  //batch checks agree with single checks
+  arr Q = rand(20, 2)*2.-1.;
+  byteA feasible;
+  rrt.areFeasible(feasible, Q);
+  for(uint i=0; i<Q.d0; i++) CHECK_EQ((bool)feasible(i), rrt.isFeasible(Q[i]), "");
+}
+
+//===========================================================================
+
+int MAIN(int argc, char** argv){
+  rai::initCmdLine(argc, argv);
+
+  rnd.clockSeed();
+
+  testPlanPath();
+
+  return 0;
+}
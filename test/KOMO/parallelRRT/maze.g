@@ -0,0 +1,11 @@
+frame floor{ shape:ssBox, X:<t(0 0 -.05)>, size:[3. 3. .1 .01], color:[.3 .3 .3] }
+
+### a wall with a gap at its upper end
+
+frame wall{ shape:ssBox, X:<t(0 -.25 .2)>, size:[.1 1.5 .4 .01], color:[.8 .3 .3], contact }
+
+### a box that moves in the plane
+
+frame robot(floor) {
+    joint:transXY, A:<t(0 0 .15)>, limits:[-1 1 -1 1]
+    shape:ssBox, size:[.2 .2 .2 .02], color:[.3 .8 .3], contact }
@@ -42,9 +42,51 @@ void TEST(Grasp){
 
 //===========================================================================
 
+void TEST(SliceTopology){
+  rai::KinematicWorld K("model.g");
+  K.optimizeTree();
+
+  //the same switching problem, with slices copied from segment templates and built one by one
+  KOMO komo[2];
+  for(uint i=0;i<2;i++){
+    komo[i].sliceTemplates = (i==0);
+    komo[i].setModel(K, false);
+    komo[i].setPathOpt(2.5, 10., 5.);
+    komo[i].setSquaredQAccelerations();
+    komo[i].add_touch(1., 1., "endeff", "stickTip");
+    komo[i].addSwitch_stable(1., -1., "endeff", "stickTip");
+    komo[i].add_touch(2., -1., "stick", "redBall");
+    komo[i].reset();
+  }
+
+  CHECK_EQ(komo[0].configurations.N, komo[1].configurations.N, "");
+  uint switched=0;
+  for(uint s=0;s<komo[0].configurations.N;s++){
+    rai::KinematicWorld &A=*komo[0].configurations(s), &B=*komo[1].configurations(s);
+    if(A.getJointStateDimension()!=komo[0].configurations(0)->getJointStateDimension()) switched++;
+    CHECK_EQ(A.frames.N, B.frames.N, "slice " <<s);
+    for(uint j=0;j<A.frames.N;j++){
+      rai::Frame *a=A.frames(j), *b=B.frames(j);
+      CHECK_EQ(a->name, b->name, "slice " <<s);
+      int pa = a->parent ? a->parent->ID : -1, pb = b->parent ? b->parent->ID : -1;
+      CHECK_EQ(pa, pb, "slice " <<s <<" frame " <<a->name);
+      CHECK_EQ(!a->joint, !b->joint, "slice " <<s <<" frame " <<a->name);
+      if(a->joint) CHECK_EQ(a->joint->type, b->joint->type, "slice " <<s <<" frame " <<a->name);
+    }
+    CHECK_EQ(A.getJointStateDimension(), B.getJointStateDimension(), "slice " <<s);
+    CHECK_ZERO(maxDiff(A.getJointState(), B.getJointState()), 1e-10, "slice " <<s);
+    CHECK_ZERO(maxDiff(A.getFrameState(), B.getFrameState()), 1e-10, "slice " <<s);
+  }
+  CHECK(switched, "the problem should switch the topology");
+  cout <<"slice topology -- SUCCESS (" <<switched <<" switched slices)" <<endl;
+}
+
+//===========================================================================
+
 int main(int argc,char** argv){
   rai::initCmdLine(argc,argv);
 
+  testSliceTopology();
   testGrasp();
 
   return 0;
@@ -0,0 +1,23 @@
+set key autotitle columnheader
+set title 'costReport ( plotting sqrt(costs) )'
+plot 'z.costReport' \
+      u (($0+1)/20):1 w l lw 3 lc 1 lt 1 \
+  ,'' u (($0+1)/20):2 w l lw 3 lc 2 lt 1 \
+  ,'' u (($0+1)/20):3 w l lw 3 lc 3 lt 1 \
+  ,'' u (($0+1)/20):4 w l lw 3 lc 4 lt 1 \
+  ,'' u (($0+1)/20):5 w l lw 3 lc 5 lt 1 \
+  ,'' u (($0+1)/20):6 w l lw 3 lc 6 lt 1 \
+  ,'' u (($0+1)/20):7 w l lw 3 lc 7 lt 1 \
+  ,'' u (($0+1)/20):8 w l lw 3 lc 8 lt 1 \
+  ,'' u (($0+1)/20):9 w l lw 3 lc 9 lt 1 \
+  ,'' u (($0+1)/20):10 w l lw 3 lc 10 lt 0 \
+  ,'' u (($0+1)/20):11 w l lw 3 lc 11 lt 0 \
+  ,'' u (($0+1)/20):12 w l lw 3 lc 12 lt 0 \
+  ,'' u (($0+1)/20):13 w l lw 3 lc 13 lt 0 \
+  ,'' u (($0+1)/20):14 w l lw 3 lc 14 lt 0 \
+  ,'' u (($0+1)/20):15 w l lw 3 lc 15 lt 0 \
+  ,'' u (($0+1)/20):16 w l lw 3 lc 16 lt 0 \
+  ,'' u (($0+1)/20):17 w l lw 3 lc 17 lt 0 \
+  ,'' u (($0+1)/20):18 w l lw 3 lc 18 lt 0 \
+  ,'' u (($0+1)/20):19 w l lw 3 lc 19 lt 0 \
+
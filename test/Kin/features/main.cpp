@@ -1,5 +1,6 @@
 #include <Kin/TM_QuaternionNorms.h>
 #include <Kin/TM_PairCollision.h>
+#include <Kin/TM_SweptPairCollision.h>
 #include <Kin/TM_angVel.h>
 #include <Kin/TM_NewtonEuler.h>
 #include <Kin/TM_energy.h>
@@ -53,6 +54,7 @@ void testFeature() {
   F.append(new TM_PairCollision (K, "obj1", "obj2", TM_PairCollision::_vector));
   F.append(new TM_PairCollision (K, "obj1", "obj2", TM_PairCollision::_normal));
   F.append(new TM_PairCollision (K, "obj1", "obj2", TM_PairCollision::_center));
+  F.append(new TM_SweptPairCollision (K, "obj1", "obj2"));
   F.append(new TM_LinAngVel (K, "obj1"));
   F.append(new TM_LinAngVel (K, "obj1")) -> order=2;
   F.append(new TM_ZeroAcc (K, "obj1"));
@@ -81,11 +83,67 @@ void testFeature() {
 
 //===========================================================================
 
+void TEST(SweptDistance) {
+  rai::KinematicWorld K;
+  rai::Frame world(K), obj1(&world), wall(&world);
+  world.name = "world";
+  obj1.name = "obj1";
+  wall.name = "wall";
+  wall.Q = "t(0 0 1)";
+
+  rai::Joint j1(obj1);
+  j1.type = rai::JT_free;
+
+  rai::Shape s1(obj1), s2(wall);
+  s1.type() = s2.type() = rai::ST_ssBox;
+  s1.size() = {.2, .2, .2, .05};
+  s2.size() = {.02, 2., 2., .01};
+  s1.createMeshes();
+  s2.createMeshes();
+  K.calc_fwdPropagateFrames();
+
+  rai::KinematicWorld K0(K), K1(K);
+  WorldL Ktuple = {&K0, &K1};
+  TM_SweptPairCollision swept(K, "obj1", "wall");
+  TM_PairCollision dist(K, "obj1", "wall", TM_PairCollision::_negScalar);
+  arr y, yd;
+
+  //moving parallel to the wall: the swept distance is the static one
+  K0.setJointState({-.5, -.3, 1., 1., 0., 0., 0.});
+  K1.setJointState({-.5, .4, 1.2, 1., 0., 0., 0.});
+  swept.__phi(y, NoArr, Ktuple);
+  dist.__phi(yd, NoArr, K0);
+  cout <<"parallel: swept=" <<y <<" static=" <<yd <<endl;
+  CHECK_ZERO(y.scalar()-yd.scalar(), 1e-6, "");
+  CHECK_ZERO(y.scalar()+(.5-.1-.01), 1e-6, "");
+
+  //passing through the wall between the slices: both slices are free, the sweep is not
+  K1.setJointState({.5, .3, 1., 1., 0., 0., 0.});
+  dist.__phi(yd, NoArr, K1);
+  CHECK_LE(yd.scalar(), -.3, "");
+  swept.__phi(y, NoArr, Ktuple);
+  cout <<"tunneling: swept=" <<y <<" static=" <<yd <<endl;
+  CHECK_GE(y.scalar(), 0., "the sweep must collide");
+
+  //gradient checks for separated sweeps and sweeps in shallow contact, with random rotations
+  //(deeper in penetration the depth switches between witness faces and is not differentiable)
+  arr x0 = cat(K0.getJointState(), K1.getJointState());
+  for(double dx:{-.8, -.6}) for(uint k=0;k<50;k++){
+    arr x = x0;
+    x(0) += dx;  x(7) += dx;
+    x += .1*(rand(x.N)-.5);
+    CHECK(checkJacobian(swept.vf(Ktuple), x, 1e-5), "swept distance Jacobian");
+  }
+}
+
+//===========================================================================
+
 int MAIN(int argc, char** argv){
   rai::initCmdLine(argc, argv);
 
   rnd.clockSeed();
 
+  testSweptDistance();
   testFeature();
 
   return 0;
@@ -187,6 +187,39 @@ void TEST(Copy){
   cout <<"** copy operator success" <<endl;
 }
 
+//===========================================================================
+
+void TEST(Snapshot){
+  rai::KinematicWorld G1("kinematicTests.g");
+  G1.writeSnapshot("z.kin");
+  rai::KinematicWorld G2("z.kin");
+
+  G2.checkConsistency();
+
+  G1 >>FILE("z.1");
+  G2 >>FILE("z.2");
+
+  charA g1,g2;
+  g1.readRaw(FILE("z.1"));
+  g2.readRaw(FILE("z.2"));
+
+  CHECK_EQ(g1, g2, "snapshot round trip failed!");
+  CHECK_ZERO(maxDiff(G1.q, G2.q), 0., "");
+
+  //the mesh payloads live in the mapped snapshot, until they grow
+  rai::Mesh *m=NULL;
+  for(rai::Frame *f:G2.frames) if(f->shape && f->shape->_mesh && f->shape->_mesh->V.N) {
+    m = f->shape->_mesh.get();
+    CHECK(m->V.local && !m->V.ownedMEM(), "mesh of '" <<f->name <<"' is not mapped");
+  }
+  CHECK(m, "no meshes");
+  uint n = m->V.d0;
+  m->scale(2.);
+  m->addMesh(rai::Mesh(*m));
+  CHECK(!m->V.local && m->V.d0==2*n, "");
+  cout <<"** snapshot success" <<endl;
+}
+
 //===========================================================================
 //
 // Kinematic speed test
@@ -619,6 +652,7 @@ int MAIN(int argc,char **argv){
 
   testLoadSave();
   testCopy();
+  testSnapshot();
   testGraph();
   testPlayStateSequence();
   testKinematics();
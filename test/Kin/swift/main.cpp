@@ -2,6 +2,8 @@
 #include <Kin/kin_swift.h>
 #include <Gui/opengl.h>
 #include <Kin/frame.h>
+#include <Geo/broadphase.h>
+#include <Geo/fclInterface.h>
 
 void TEST(Swift) {
   rai::KinematicWorld K("swift_test.g");
@@ -49,11 +51,91 @@ void TEST(CollisionTiming){
   CHECK(time>0.01 && time<1.,"strange time for collision checking!");
 }
 
+//===========================================================================
+
+void TEST(BroadphaseTiming){
+  //a scene with many small objects, drifting randomly
+  rai::KinematicWorld K;
+  uint n=250;
+  for(uint k=0;k<n;k++){
+    rai::Frame *f = K.addFrame(STRING("obj" <<k));
+    f->setShape(rai::ST_ssBox, {.2, .1, .1, .02});
+    f->shape->cont=1;
+    f->X.setRandom();
+    f->X.pos.set(2.*rnd.uni(-1.,1.), 2.*rnd.uni(-1.,1.), rnd.uni(0.,1.));
+  }
+  cout <<"# shapes: " <<K.frames.N <<endl;
+
+  uint T=100;
+  arr drift = .01*randn(n,3);
+  auto move = [&](){
+    for(rai::Frame *f:K.frames){
+      f->X.pos += rai::Vector(drift[f->ID]);
+      f->X.addRelativeRotationDeg(1.,0,0,1);
+    }
+  };
+
+  //-- raw broadphase: number of candidate pairs vs brute-force AABB tests
+  rai::SweepAndPrune bp(n);
+  for(rai::Frame *f:K.frames) bp.setLocalBox(f->ID, f->shape->mesh().getBox());
+  for(uint i=0;i<n;i++) for(uint j=0;j<i;j++) bp.allowPair(i,j);
+  rai::timerStart();
+  for(uint t=0;t<T;t++){
+    move();
+    for(rai::Frame *f:K.frames) bp.setPose(f->ID, f->X.getArr7d().p);
+    bp.step();
+  }
+  cout <<"sweep&prune: sec/step=" <<rai::timerRead()/T <<" #pairs=" <<bp.nPairs <<endl;
+
+  uint m=0;
+  for(uint i=0;i<n;i++) for(uint j=0;j<i;j++){
+    double *a=bp.box[i].p, *b=bp.box[j].p;
+    if(a[0]<=b[3] && b[0]<=a[3] && a[1]<=b[4] && b[1]<=a[4] && a[2]<=b[5] && b[2]<=a[5]) m++;
+  }
+  CHECK_EQ(m, bp.nPairs, "sweep&prune misses or duplicates pairs");
+
+  //-- full collision paths
+  rai::timerStart();
+  for(uint t=0;t<T;t++){ move(); K.stepSwift(); }
+  cout <<"swift: sec/step=" <<rai::timerRead()/T <<" #proxies=" <<K.proxies.N <<endl;
+
+  rai::timerStart();
+  for(uint t=0;t<T;t++){ move(); K.stepFcl(); }
+  cout <<"fcl (sweep&prune broadphase): sec/step=" <<rai::timerRead()/T <<" #proxies=" <<K.proxies.N <<endl;
+
+  //-- the former fcl path: dynamic AABB tree over all objects, a fresh pose array per step, canCollideWith per reported pair
+  rai::Array<ptr<rai::Mesh>> geometries(K.frames.N);
+  for(rai::Frame *f:K.frames) geometries(f->ID) = f->shape->_mesh;
+  rai::FclInterface former(geometries, 0., true);
+  auto stepFormer = [&](){
+    arr X(K.frames.N, 7);
+    X.setZero();
+    for(rai::Frame *f:K.frames) if(f->shape && f->shape->cont) X[f->ID] = f->X.getArr7d();
+    former.step(X);
+    uint count=0;
+    for(uint i=0;i<former.collisions.d0;i++) if(K.frames(former.collisions(i,0))->shape->canCollideWith(K.frames(former.collisions(i,1)))) count++;
+    return count;
+  };
+  uint nFormer=0;
+  rai::timerStart();
+  for(uint t=0;t<T;t++){ move(); nFormer=stepFormer(); }
+  cout <<"fcl (former dynamic AABB tree): sec/step=" <<rai::timerRead()/T <<" #proxies=" <<nFormer <<endl;
+
+  //both fcl paths find the same collisions
+  K.stepFcl();
+  CHECK_EQ(stepFormer(), K.proxies.N, "");
+}
+
+//===========================================================================
+
 int MAIN(int argc, char** argv){
   rai::initCmdLine(argc, argv);
 
   testSwift();
 //  testCollisionTiming();
+#ifdef RAI_FCL
+  testBroadphaseTiming();
+#endif
 
   return 0;
 }
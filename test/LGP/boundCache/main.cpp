@@ -0,0 +1,132 @@
+#include <LGP/boundCache.h>
+#include <Kin/frame.h>
+
+//===========================================================================
+
+rai::KinematicWorld scene(){
+  rai::KinematicWorld K;
+  rai::Frame *world = new rai::Frame(K);
+  world->name = "world";
+  for(const char* name:{"table", "box", "gripper"}){
+    rai::Frame *f = new rai::Frame(world);
+    f->name = name;
+    rai::Shape *s = new rai::Shape(*f);
+    s->type() = rai::ST_box;
+    s->size() = {.1, .1, .1};
+  }
+  K.getFrameByName("box")->Q.pos.set(.5, 0., 1.);
+  K.calc_fwdPropagateFrames();
+  return K;
+}
+
+BoundCache::Entry entry(double cost){
+  BoundCache::Entry e;
+  e.cost = cost;
+  e.feasible = true;
+  e.x = {cost, 2.*cost};
+  return e;
+}
+
+//===========================================================================
+
+void TEST(Key){
+  rai::KinematicWorld K = scene();
+  Skeleton S = {
+    {1., 1., SY_touch, {"gripper", "box"}},
+    {1., 2., SY_stable, {"gripper", "box"}},
+    {2., -1., SY_above, {"box", "table"}},
+  };
+  std::string key = BoundCache::getKey(BD_seq, S, K, false, true, {}, {});
+
+  //the order of skeleton entries does not matter
+  Skeleton other = {S(2), S(0), S(1)};
+  CHECK(BoundCache::getKey(BD_seq, other, K, false, true, {}, {})==key, "");
+
+  //but everything else does
+  CHECK(BoundCache::getKey(BD_path, S, K, false, true, {}, {})!=key, "");
+  CHECK(BoundCache::getKey(BD_seq, S, K, true, true, {}, {})!=key, "");
+  CHECK(BoundCache::getKey(BD_seq, S, K, false, false, {}, {})!=key, "");
+  CHECK(BoundCache::getKey(BD_seq, S, K, false, true, {ARR(1.)}, {})!=key, "");
+  other = S;
+  other(2).phase1 = 3.;
+  CHECK(BoundCache::getKey(BD_seq, other, K, false, true, {}, {})!=key, "");
+
+  //start state: round-off noise is ignored, a moved frame is not
+  rai::KinematicWorld K2 = scene();
+  K2.getFrameByName("box")->X.pos.x += 1e-9;
+  CHECK(BoundCache::getKey(BD_seq, S, K2, false, true, {}, {})==key, "");
+  K2.getFrameByName("box")->X.pos.x += 1e-3;
+  CHECK(BoundCache::getKey(BD_seq, S, K2, false, true, {}, {})!=key, "");
+}
+
+//===========================================================================
+
+void TEST(LeastRecentlyUsed){
+  BoundCache cache(2);
+  cache.add("a", entry(1.));
+  cache.add("b", entry(2.));
+  CHECK(!cache.find("c"), "");
+  CHECK(cache.find("a"), "");   //now 'b' is the least recently used
+  cache.add("c", entry(3.));
+  CHECK_EQ(cache.size(), 2, "");
+  CHECK_EQ(cache.evictions, 1, "");
+  CHECK(!cache.find("b"), "");
+  CHECK_EQ(cache.find("a")->cost, 1., "");
+  CHECK_EQ(cache.find("c")->cost, 3., "");
+  CHECK_EQ(cache.hits, 3, "");
+  CHECK_EQ(cache.misses, 2, "");
+
+  //overwriting an entry does not evict
+  cache.add("a", entry(4.));
+  CHECK_EQ(cache.size(), 2, "");
+  CHECK_EQ(cache.find("a")->cost, 4., "");
+
+  //keys are compared in full, including zero bytes
+  std::string k1("x\0y", 3), k2("x\0z", 3);
+  cache.add(k1, entry(5.));
+  CHECK(!cache.find(k2), "");
+  CHECK_EQ(cache.find(k1)->cost, 5., "");
+
+  //a disabled cache stores nothing
+  BoundCache none;
+  none.add("a", entry(1.));
+  CHECK_EQ(none.size(), 0, "");
+}
+
+//===========================================================================
+
+void TEST(SaveLoad){
+  std::string k1("one\0\n", 5), k2("two two", 7);
+  {
+    BoundCache cache(3);
+    cache.add(k1, entry(1.));
+    cache.add(k2, entry(2.5));
+    cache.find(k1);            //k2 is now the least recently used
+    cache.save("z.cache");
+  }
+  BoundCache cache(2);
+  CHECK(cache.load("z.cache"), "");
+  CHECK_EQ(cache.size(), 2, "");
+  BoundCache::Entry *e = cache.find(k2);
+  CHECK(e, "");
+  CHECK_EQ(e->cost, 2.5, "");
+  CHECK(e->feasible, "");
+  CHECK_ZERO(maxDiff(e->x, ARR(2.5, 5.)), 1e-10, "");
+
+  //the recency order is restored: k1 was used after k2, so it is evicted after the lookup of k2
+  cache.add("three", entry(3.));
+  CHECK(!cache.find(k1), "");
+  CHECK(cache.find(k2), "");
+}
+
+//===========================================================================
+
+int MAIN(int argc, char** argv){
+  rai::initCmdLine(argc, argv);
+
+  testKey();
+  testLeastRecentlyUsed();
+  testSaveLoad();
+
+  return 0;
+}
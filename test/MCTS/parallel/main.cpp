@@ -0,0 +1,38 @@
+#include <MCTS/solver_parallel.h>
+#include <MCTS/problem_BlindBranch.h>
+
+void testMode(ParallelMCTS::Mode mode){
+  uint threads=4, H=6;
+  rai::Array<MCTS_Environment*> worlds;
+  for(uint i=0;i<threads;i++) worlds.append(new BlindBranch(H));
+
+  ParallelMCTS M(worlds, mode);
+  for(uint k=0;k<5;k++) M.addRollouts(400);
+  M.report(cout);
+
+  //each rollout visits the root once; only rollouts that found the root unexpanded miss the root decisions
+  uintA N = M.Nvisits();
+  CHECK_EQ(M.rollouts, 2000, "");
+  CHECK_EQ(N.N, 2, "");
+  CHECK_LE(sum(N), M.rollouts, "");
+  CHECK_GE(sum(N)+threads, M.rollouts, "root visits are lost");
+
+  //the +1 branch is the only one that can reach the maximal return
+  CHECK_EQ(M.getBestActionIdx(), 1, "");
+  CHECK_GE(M.Qfunction()(1), M.Qfunction()(0), "");
+
+  for(MCTS_Environment *w:worlds) delete w;
+}
+
+void TEST(TreeParallel){ testMode(ParallelMCTS::treeParallel); }
+
+void TEST(RootParallel){ testMode(ParallelMCTS::rootParallel); }
+
+int MAIN(int argc,char** argv){
+  rai::initCmdLine(argc, argv);
+
+  testTreeParallel();
+  testRootParallel();
+
+  return 0;
+}
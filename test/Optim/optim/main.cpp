@@ -39,9 +39,98 @@ void TEST(LambdaFunction){
 
 //===========================================================================
 
+void TEST(NewtonCounts) {
+  rnd.seed(0);
+  NonlinearlyWarpedSquaredCost warped(4, 10.);
+  VectorFunction warpedF = [&warped](arr& y, arr& J, const arr& x) { warped.fv(y, J, x); };
+  OptOptions opt;
+  opt.stopTolerance=1e-8;  opt.stopEvals=opt.stopIters=1000;
+  opt.damping=1e-3;  opt.maxStep=-1.;  opt.verbose=0;
+  struct Case { const char* name; ScalarFunction f; arr x0; double fmin; };
+  rai::Array<Case> cases = {
+    {"square", SquareFunction(), {1., -2., 3.}, 0.},
+    {"hole", HoleFunction(), {.5, -.3}, 0.},
+    {"warped", conv_VectorFunction2ScalarFunction(warpedF), {3., -2., 1., 4.}, 0.},
+  };
+  for(Case& c:cases) for(bool model:{false, true}){
+    arr x = c.x0;
+    opt.modelRejection = model;
+    OptNewton newton(x, c.f, opt);
+    newton.run();
+    cout <<c.name <<(model?" (model rejection)":"") <<": its=" <<newton.its <<" evals=" <<newton.evals <<" modelRejects=" <<newton.modelRejects <<" f=" <<newton.fx <<endl;
+    CHECK_ZERO(newton.fx-c.fmin, 1e-6, c.name);
+    CHECK_LE(newton.evals, newton.its+3, "line search wasted evaluations on " <<c.name);
+    CHECK_LE(newton.its, 10, c.name);
+    if(!model) CHECK_EQ(newton.modelRejects, 0, "");
+
+    //reinit restarts without a model restriction
+    newton.reinit(c.x0);
+    CHECK_EQ(newton.modelRadius, -1., "");
+  }
+}
+
+void TEST(ParallelLineSearch) {
+  rnd.seed(0);
+  NonlinearlyWarpedSquaredCost warped(4, 10.);
+  OptOptions opt;
+  opt.stopTolerance=1e-8;  opt.stopEvals=opt.stopIters=1000;
+  opt.damping=1e-3;  opt.maxStep=-1.;  opt.verbose=0;
+  opt.allowOverstep=true;  opt.initStep=4.; //forces backtracking
+
+  //every instance works on its own copy of the problem and counts its calls
+  auto instance = [&warped](std::shared_ptr<uint> calls) {
+    auto problem = std::make_shared<NonlinearlyWarpedSquaredCost>(warped);
+    ScalarFunction f = [problem, calls](arr& g, arr& H, const arr& x) {
+      (*calls)++;
+      arr y, J;
+      problem->fv(y, J, x);
+      if(!!g) g = 2.*comp_At_x(J, y);
+      if(!!H) H = 2.*comp_At_A(J);
+      return sumOfSqr(y);
+    };
+    return f;
+  };
+
+  arr x0 = {3., -2., 1., 4.}, x = x0;
+  OptNewton sequential(x, instance(std::make_shared<uint>(0)), opt);
+  sequential.run();
+
+  auto calls = std::make_shared<uint>(0);
+  rai::Array<std::shared_ptr<uint>> counts;
+  x = x0;
+  OptNewton parallel(x, instance(calls), opt);
+  parallel.setCandidateFunctions([&counts, &instance]() { return instance(counts.append(std::make_shared<uint>(0))); }, 4);
+  parallel.run();
+
+  cout <<"sequential: its=" <<sequential.its <<" evals=" <<sequential.evals <<" f=" <<sequential.fx <<endl;
+  cout <<"parallel: its=" <<parallel.its <<" evals=" <<parallel.evals <<" f=" <<parallel.fx <<endl;
+  CHECK_ZERO(sequential.fx, 1e-6, "");
+  CHECK_ZERO(parallel.fx, 1e-6, "");
+  CHECK_EQ(*calls, 1, "the original function is only evaluated at the start");
+  CHECK_EQ(counts.N, 4, "");
+  uint rounds = *counts(0);
+  for(auto& c:counts) CHECK_EQ(*c, rounds, "every candidate is evaluated in each round");
+  CHECK_EQ(parallel.evals, 1+4*rounds, "");
+  CHECK_LE(rounds, sequential.evals-1, "fewer sequential evaluation rounds");
+
+  //the model rejects the overlong steps without evaluating them
+  x = x0;
+  opt.modelRejection = true;
+  OptNewton model(x, instance(std::make_shared<uint>(0)), opt);
+  model.run();
+  cout <<"model rejection: its=" <<model.its <<" evals=" <<model.evals <<" modelRejects=" <<model.modelRejects <<" f=" <<model.fx <<endl;
+  CHECK_ZERO(model.fx, 1e-6, "");
+  CHECK(model.modelRejects>0, "");
+  CHECK(model.evals<sequential.evals, "the rejections save evaluations");
+}
+
+//===========================================================================
+
 int MAIN(int argc,char** argv){
   rai::initCmdLine(argc,argv);
 
+  testNewtonCounts();
+  testParallelLineSearch();
   testSqrProblem();
   testLambdaFunction();
 
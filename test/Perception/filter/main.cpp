@@ -0,0 +1,70 @@
+#include <Perception/filter.h>
+
+//===========================================================================
+
+PerceptPtr newBox(double x, double y, double z){
+  rai::Transformation X(0);
+  X.pos.set(x, y, z);
+  return make_shared<PercBox>(X, ARR(.1, .1, .1), ARR(1., 0., 0.));
+}
+
+void TEST(Association){
+  Filter filter;
+  filter.threadClose(); //step manually
+  filter.createNewPercepts = true;
+  filter.modelWorld.set()->init("model.g");
+
+  //-- two new objects
+  filter.percepts_input.set()->append({newBox(0., 0., 1.), newBox(2., 0., 1.)});
+  filter.step();
+  PerceptL database = filter.percepts_filtered.get();
+  CHECK_EQ(database.N, 2, "");
+  CHECK_EQ(database(0)->id, 1, "");
+  CHECK_EQ(database(1)->id, 2, "");
+
+  //-- the first input is close to object 1; the second is beyond the gate (default .5) of object 2
+  PerceptL inputs = {newBox(.1, 0., 1.), newBox(2.7, 0., 1.)};
+  filter.percepts_input.set()->append(inputs);
+  filter.step();
+  database = filter.percepts_filtered.get();
+  CHECK_EQ(database.N, 3, "");
+  CHECK_EQ(inputs(0)->id, 1, "fused with object 1");
+  CHECK_EQ(inputs(1)->id, 3, "a new object");
+  CHECK(database(0)->pose.pos.x>1e-3, "object 1 moved towards its input");
+
+  //-- neighbors across a cell boundary of the spatial hash are associated
+  inputs = {newBox(-.49, 0., 1.)};
+  filter.percepts_input.set()->append(inputs);
+  filter.step();
+  inputs = {newBox(-.51, 0., 1.)};
+  filter.percepts_input.set()->append(inputs);
+  filter.step();
+  database = filter.percepts_filtered.get();
+  CHECK_EQ(database.N, 4, "");
+  CHECK_EQ(inputs(0)->id, 4, "");
+
+  //-- two inputs competing for the same object: the closer one is fused, the other becomes new
+  inputs = {newBox(3.1, 0., 1.), newBox(2.72, 0., 1.)};
+  filter.percepts_input.set()->append(inputs);
+  filter.step();
+  database = filter.percepts_filtered.get();
+  CHECK_EQ(database.N, 5, "");
+  CHECK_EQ(inputs(0)->id, 5, "");
+  CHECK_EQ(inputs(1)->id, 3, "");
+
+  //-- inputs of another type are never associated with boxes
+  inputs = {make_shared<PercCluster>(ARR(.1, 0., 1.), ARR(.1, 0., 1.), "world")};
+  filter.percepts_input.set()->append(inputs);
+  filter.step();
+  CHECK_EQ(inputs(0)->id, 6, "");
+}
+
+//===========================================================================
+
+int MAIN(int argc, char** argv){
+  rai::initCmdLine(argc, argv);
+
+  testAssociation();
+
+  return 0;
+}
@@ -0,0 +1,3 @@
+frame world{}
+
+frame S1(world){ joint:free, shape:ssBox, size:[.1 .1 .1 .01] }
@@ -0,0 +1,220 @@
+#include <Kin/kin.h>
+#include <Kin/frame.h>
+#include <Kin/proxy.h>
+#include <Kin/kin_swift.h>
+#include <Geo/pairCollision.h>
+#include <KOMO/komo.h>
+#include <LGP/LGP_tree.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <functional>
+#include <memory>
+#include <new>
+
+//===========================================================================
+//
+// performance benchmarks of the kinematics, collision and KOMO hot paths
+//
+// Every benchmark reseeds rnd, runs 'bench/warmup' untimed warm-up runs, then
+// 'bench/runs' timed runs; reported are median and p95 of the time per run and the
+// mean number of heap allocations (malloc, i.e. also operator new and the array pool's
+// blocks) per run. All results are written as JSON to 'bench/output', to track
+// regressions across versions. Not part of 'make tests'/'make runTests': build and run
+// explicitly with 'make benchmarks' in the root.
+//
+
+static std::atomic<uint64_t> allocations(0);
+
+//interposes glibc's malloc/calloc for the whole process (operator new and the libraries call these)
+extern "C" void* __libc_malloc(size_t n);
+extern "C" void* __libc_calloc(size_t n, size_t size);
+extern "C" void* malloc(size_t n) { allocations++; return __libc_malloc(n); }
+extern "C" void* calloc(size_t n, size_t size) { allocations++; return __libc_calloc(n, size); }
+
+static double now() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static rai::String json;
+
+/// setup is untimed and called before every run; each run calls body 'iterations' times
+void bench(const char* name, uint iterations, const std::function<void()>& setup, const std::function<void()>& body) {
+  uint warmup = rai::getParameter<uint>("bench/warmup", 3);
+  uint runs = rai::getParameter<uint>("bench/runs", 20);
+  rnd.seed(0);
+  for(uint k=0; k<warmup; k++) { setup(); for(uint i=0; i<iterations; i++) body(); }
+  arr times(runs);
+  uint64_t allocs=0;
+  for(uint k=0; k<runs; k++) {
+    setup();
+    uint64_t a = allocations;
+    double time = now();
+    for(uint i=0; i<iterations; i++) body();
+    times(k) = now()-time;
+    allocs += allocations-a;
+  }
+  std::sort(times.p, times.p+times.N);
+  double median = times(runs/2), p95 = times((95*runs+99)/100-1); //nearest rank: ceil(.95*runs)-1
+  double allocsPerRun = double(allocs)/runs;
+  cout <<std::setw(28) <<std::left <<name <<" median=" <<median <<"s p95=" <<p95 <<"s allocations=" <<allocsPerRun
+       <<"  (" <<runs <<" runs of " <<iterations <<" iterations)" <<endl;
+  json <<(json.N?",\n":"") <<"  { \"name\": \"" <<name <<"\", \"iterations\": " <<iterations <<", \"runs\": " <<runs
+       <<", \"median\": " <<median <<", \"p95\": " <<p95 <<", \"allocations\": " <<allocsPerRun <<" }";
+}
+
+void bench(const char* name, uint iterations, const std::function<void()>& body) {
+  bench(name, iterations, [](){}, body);
+}
+
+void skip(const char* name, const char* reason) {
+  cout <<std::setw(28) <<std::left <<name <<" skipped: " <<reason <<endl;
+  json <<(json.N?",\n":"") <<"  { \"name\": \"" <<name <<"\", \"skipped\": \"" <<reason <<"\" }";
+}
+
+//===========================================================================
+
+void benchKinematics() {
+  rai::KinematicWorld K("../../KOMO/komo/arm.g");
+  rai::Frame *endeff = K["endeff"];
+  arr q0 = K.getJointState(), J;
+
+  bench("calc_fwdPropagateFrames", 1000, [&]() {
+    K.q = q0 + .1*randn(q0.N);
+    K.calc_Q_from_q();
+    K.calc_fwdPropagateFrames();
+  });
+
+  bench("jacobianPos", 1000, [&]() {
+    K.setJointState(q0 + .1*randn(q0.N));
+    K.jacobianPos(J, endeff, endeff->X.pos);
+  });
+
+  bench("KinematicWorld::copy", 100, [&]() {
+    rai::KinematicWorld C;
+    C.copy(K);
+  });
+}
+
+//===========================================================================
+
+void benchCollisions() {
+  rai::KinematicWorld K("../../KOMO/komo/arm.g");
+  arr q0 = K.getJointState();
+
+  K.swift().setCutoff(1.);
+  bench("stepSwift", 100, [&]() {
+    K.setJointState(q0 + randn(q0.N));
+    K.stepSwift();
+  });
+
+#ifdef RAI_FCL
+  bench("stepFcl", 100, [&]() {
+    K.setJointState(q0 + randn(q0.N));
+    K.stepFcl();
+  });
+#else
+  skip("stepFcl", "compiled without FCL");
+#endif
+
+  rai::Mesh m1, m2;
+  rai::Transformation X1, X2;
+  bench("PairCollision", 1000, [&]() {
+    m1.clear();  m1.setRandom();
+    m2.clear();  m2.setRandom();
+    X1.setRandom();  X2.setRandom();
+  }, [&]() {
+    PairCollision coll(m1, m2, X1, X2, .1, .1);
+  });
+}
+
+//===========================================================================
+
+void setupKOMO(KOMO& komo, const rai::KinematicWorld& K, bool align) {
+  komo.setModel(K, false);
+  komo.setPathOpt(1., 100, 5.);
+  komo.setSquaredQAccelerations();
+  if(align) {
+    komo.addObjective({1.}, OT_sos, FS_positionRel, {"target", "endeff"});
+    komo.addObjective({1.}, OT_sos, FS_scalarProductZZ, {"target", "endeff"}, {1e2}, {1.});
+  } else {
+    komo.addObjective({1.}, OT_sos, FS_positionDiff, {"endeff", "target"}, {1e1});
+  }
+  komo.setSlowAround(1., .05);
+  komo.verbose=0;
+}
+
+void benchKOMO() {
+  rai::KinematicWorld K("../../KOMO/komo/arm.g");
+  std::shared_ptr<KOMO> komo;
+
+  bench("KOMO::setupConfigurations", 1, [&]() {
+    komo = std::make_shared<KOMO>();
+    setupKOMO(*komo, K, false);
+  }, [&]() {
+    komo->setupConfigurations();
+  });
+
+  for(bool align: {false, true}) {
+    bench(align?"KOMO::optimize(align)":"KOMO::optimize(easy)", 1, [&]() {
+      komo = std::make_shared<KOMO>();
+      setupKOMO(*komo, K, align);
+    }, [&]() {
+      komo->optimize();
+    });
+  }
+  komo.reset();
+}
+
+//===========================================================================
+
+void benchLGP() {
+  rai::String model = rai::raiPath("../rai-robotModels/pr2/pr2.g");
+  if(!std::ifstream(model.p).good()) { skip("LGP_Tree::run", "rai-robotModels not found"); return; }
+
+  //the pickAndPlace scene of test/LGP/pickAndPlace, with a fixed object placement
+  rai::KinematicWorld K;
+  K.addFile(model);
+  K["pr2L"]->ats.newNode<Graph>({"logical"}, {}, {{"gripper", true}});
+  K["pr2R"]->ats.newNode<Graph>({"logical"}, {}, {{"gripper", true}});
+  K.addFile(rai::raiPath("../rai-robotModels/objects/tables.g"));
+  for(uint i=0; i<4; i++) {
+    rai::Frame *f = K.addFrame(STRING("obj"<<i), "table1", "type:ssBox size:[.1 .1 .2 .02] color:[1. 0. 0.], contact, logical={ object }, joint:rigid");
+    f->Q.pos = {-.3+.2*i, -.6+.4*i, .15};
+  }
+  rai::Frame *f = K.addFrame("tray", "table2", "type:ssBox size:[.15 .15 .04 .02] color:[0. 1. 0.], logical={ table }");
+  f->Q.pos = {0., 0., .07};
+  K.calc_fwdPropagateFrames();
+  K.selectJointsByGroup({"base", "armL", "armR"}, true, true);
+  K.optimizeTree();
+
+  std::shared_ptr<LGP_Tree> lgp;
+  uint steps = rai::getParameter<uint>("bench/lgpSteps", 10);
+  bench("LGP_Tree::run", 1, [&]() {
+    lgp = std::make_shared<LGP_Tree>(K, "../../LGP/pickAndPlace/fol-pnp-switch.g");
+    lgp->fol.addTerminalRule("(on tray obj0) (on tray obj1) (on tray obj2)");
+  }, [&]() {
+    lgp->run(steps);
+  });
+  lgp.reset();
+}
+
+//===========================================================================
+
+int MAIN(int argc,char **argv){
+  rai::initCmdLine(argc, argv);
+
+  benchKinematics();
+  benchCollisions();
+  benchKOMO();
+  if(rai::getParameter<bool>("bench/LGP", true)) benchLGP();
+
+  rai::String output = rai::getParameter<rai::String>("bench/output", STRING("z.bench.json"));
+  ofstream fil(output);
+  fil <<"{ \"benchmarks\": [\n" <<json <<"\n] }" <<endl;
+  cout <<"-- written to " <<output <<endl;
+
+  return 0;
+}